@@ -0,0 +1,66 @@
+#pragma once
+
+#include "nucleus/config.h"
+#include "nucleus/types.h"
+
+#if COMPILER(MSVC)
+#include <intrin.h>
+#endif
+
+namespace nu {
+
+constexpr bool is_power_of_two(MemSize value) {
+  return value != 0 && (value & (value - 1)) == 0;
+}
+
+// Returns the number of zero bits below the lowest set bit.  `value` must not be 0.
+inline U32 count_trailing_zeros(U32 value) {
+#if COMPILER(GCC)
+  return static_cast<U32>(__builtin_ctz(value));
+#elif COMPILER(MSVC)
+  unsigned long index;
+  _BitScanForward(&index, value);
+  return static_cast<U32>(index);
+#endif
+}
+
+// Returns the number of zero bits below the lowest set bit.  `value` must not be 0.
+inline U32 count_trailing_zeros(U64 value) {
+#if COMPILER(GCC)
+  return static_cast<U32>(__builtin_ctzll(value));
+#elif COMPILER(MSVC) && ARCH(CPU_64_BITS)
+  unsigned long index;
+  _BitScanForward64(&index, value);
+  return static_cast<U32>(index);
+#elif COMPILER(MSVC)
+  U32 low = static_cast<U32>(value);
+  return low ? count_trailing_zeros(low) : 32 + count_trailing_zeros(static_cast<U32>(value >> 32));
+#endif
+}
+
+// Returns the number of zero bits above the highest set bit.  `value` must not be 0.
+inline U32 count_leading_zeros(U32 value) {
+#if COMPILER(GCC)
+  return static_cast<U32>(__builtin_clz(value));
+#elif COMPILER(MSVC)
+  unsigned long index;
+  _BitScanReverse(&index, value);
+  return 31 - static_cast<U32>(index);
+#endif
+}
+
+// Returns the number of zero bits above the highest set bit.  `value` must not be 0.
+inline U32 count_leading_zeros(U64 value) {
+#if COMPILER(GCC)
+  return static_cast<U32>(__builtin_clzll(value));
+#elif COMPILER(MSVC) && ARCH(CPU_64_BITS)
+  unsigned long index;
+  _BitScanReverse64(&index, value);
+  return 63 - static_cast<U32>(index);
+#elif COMPILER(MSVC)
+  U32 high = static_cast<U32>(value >> 32);
+  return high ? count_leading_zeros(high) : 32 + count_leading_zeros(static_cast<U32>(value));
+#endif
+}
+
+}  // namespace nu
@@ -104,3 +104,9 @@
 #else
 #error Please add support for your architecture in nucleus/config.h
 #endif
+
+// Instruction set extensions that are guaranteed to be available for the target.
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define ARCH_CPU_SSE2 1
+#endif
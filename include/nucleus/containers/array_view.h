@@ -33,24 +33,11 @@ public:
     return data_[index];
   };
 
-  T& operator[](MemSize index) {
-    DCHECK(index < size_);
-    return data_[index];
-  };
-
-  T* begin() const {
-    return data_;
-  }
-
-  T* begin() {
+  const T* begin() const {
     return data_;
   }
 
-  T* end() {
-    return data_ + size_;
-  }
-
-  T* end() const {
+  const T* end() const {
     return data_ + size_;
   }
 
@@ -0,0 +1,163 @@
+#pragma once
+
+#include <utility>
+
+#include "nucleus/bits.h"
+#include "nucleus/containers/hash_map.h"
+#include "nucleus/synchronization/auto_lock.h"
+#include "nucleus/synchronization/lock.h"
+#include "nucleus/threading/worker_pool.h"
+
+namespace nu {
+
+// A hash map that can be used from many threads at the same time.  Keys are spread over
+// `ShardCount` shards, each a `HashMap` with its own lock, so threads only contend when they work
+// on keys in the same shard.  Values are only ever touched with the lock of their shard held, so
+// they are either copied out or handed to a callback.  `Hasher` is passed on to the maps of the
+// shards, so maps with untrusted keys can use `SeededHash`.
+template <typename KeyType, typename ValueType, MemSize ShardCount = 16,
+          template <typename> class Hasher = Hash>
+class ConcurrentHashMap {
+  static_assert(is_power_of_two(ShardCount), "Shard count must be a power of two.");
+  static_assert(ShardCount <= 256, "Shard count is picked from 8 bits of the hash.");
+
+public:
+  using MapType = HashMap<KeyType, ValueType, GroupProbing, Hasher>;
+
+  static constexpr MemSize shard_count() {
+    return ShardCount;
+  }
+
+  ConcurrentHashMap() = default;
+
+  // Takes the lock of every shard in turn, so the result might be stale by the time it is used.
+  NU_NO_DISCARD MemSize size() const {
+    MemSize size = 0;
+    for (auto& shard : shards_) {
+      AutoLock<Lock> locker{shard.lock};
+      size += shard.map.size();
+    }
+    return size;
+  }
+
+  // Returns true if the key was not in the map yet.  An existing value is replaced.
+  bool insert(const KeyType& key, ValueType value) {
+    auto hash = Hasher<KeyType>::hashed(key);
+    auto& shard = shard_for(hash);
+
+    AutoLock<Lock> locker{shard.lock};
+    return shard.map.insert_with_hash(hash, key, std::move(value)).is_new();
+  }
+
+  // Inserts `value` if the key is not in the map yet.  Otherwise `merge(ValueType& existing,
+  // ValueType&& value)` is called to combine the two.  Returns true if the key was not in the map
+  // yet.
+  template <typename Merge>
+  bool upsert(const KeyType& key, ValueType value, Merge&& merge) {
+    auto hash = Hasher<KeyType>::hashed(key);
+    auto& shard = shard_for(hash);
+
+    AutoLock<Lock> locker{shard.lock};
+    auto result = shard.map.find_with_hash(hash, key);
+    if (result.was_found()) {
+      merge(result.value(), std::move(value));
+      return false;
+    }
+
+    shard.map.insert_with_hash(hash, key, std::move(value));
+    return true;
+  }
+
+  // Calls `callback(ValueType&)` with the value of `key`, if it is found.  The shard stays locked
+  // while the callback runs, so keep it short.
+  template <typename Callback>
+  bool find(const KeyType& key, Callback&& callback) const {
+    auto hash = Hasher<KeyType>::hashed(key);
+    auto& shard = shard_for(hash);
+
+    AutoLock<Lock> locker{shard.lock};
+    auto result = shard.map.find_with_hash(hash, key);
+    if (!result.was_found()) {
+      return false;
+    }
+
+    callback(result.value());
+    return true;
+  }
+
+  // Copies the value of `key` into `value`, if it is found.
+  bool find(const KeyType& key, ValueType* value) const {
+    DCHECK(value);
+
+    return find(key, [value](const ValueType& found) {
+      *value = found;
+    });
+  }
+
+  bool contains_key(const KeyType& key) const {
+    auto hash = Hasher<KeyType>::hashed(key);
+    auto& shard = shard_for(hash);
+
+    AutoLock<Lock> locker{shard.lock};
+    return shard.map.find_with_hash(hash, key).was_found();
+  }
+
+  // Returns true if the key was found and removed from the map.
+  bool remove(const KeyType& key) {
+    auto hash = Hasher<KeyType>::hashed(key);
+    auto& shard = shard_for(hash);
+
+    AutoLock<Lock> locker{shard.lock};
+    return shard.map.remove_with_hash(hash, key);
+  }
+
+  // Calls `callback(MapType&)` with the map of a single shard while holding its lock.  Shards are
+  // independent, so threads working on different shards can iterate the whole map in parallel.
+  template <typename Callback>
+  void visit_shard(MemSize shard_index, Callback&& callback) {
+    DCHECK(shard_index < ShardCount);
+
+    auto& shard = shards_[shard_index];
+    AutoLock<Lock> locker{shard.lock};
+    callback(shard.map);
+  }
+
+  // Calls `callback(MemSize shard_index, MapType&)` for every shard, holding only the lock of the
+  // shard that is being visited.  The shards are spread over the threads of `WorkerPool::shared`,
+  // so the callback can run on several threads at the same time and in any order.
+  template <typename Callback>
+  void for_each_shard(Callback&& callback) {
+    auto visit_range = [&](MemSize begin, MemSize end) {
+      for (MemSize i = begin; i < end; ++i) {
+        visit_shard(i, [&](MapType& map) {
+          callback(i, map);
+        });
+      }
+    };
+    WorkerPool::shared().run(ShardCount, 1, visit_range);
+  }
+
+private:
+  NU_DELETE_COPY_AND_MOVE(ConcurrentHashMap);
+
+  // Every shard starts on its own cache line, so locking one shard does not slow down threads
+  // working on its neighbours.
+  struct alignas(CACHE_LINE_SIZE) Shard {
+    Lock lock;
+    MapType map;
+  };
+
+  // The probe sequence inside a shard starts from the low bits of `detail::fibonacci_index`, so the
+  // shard is picked from its high bits to keep the two independent.
+  static MemSize shard_index_for(HashedValue hash) {
+    return (detail::fibonacci_index(hash) >> 24) & (ShardCount - 1);
+  }
+
+  Shard& shard_for(HashedValue hash) const {
+    return shards_[shard_index_for(hash)];
+  }
+
+  mutable Shard shards_[ShardCount];
+};
+
+}  // namespace nu
@@ -1,21 +1,34 @@
 #pragma once
 
 #include <algorithm>
+#include <cstdlib>
 #include <cstring>
 #include <functional>
+#include <memory>
 #include <new>
 #include <type_traits>
 #include <utility>
 
 #include "nucleus/containers/array_view.h"
 #include "nucleus/logging.h"
+#include "nucleus/macros.h"
+#include "nucleus/memory/allocator.h"
 #include "nucleus/types.h"
 
 #undef free
 
 namespace nu {
 
+// Types that can be moved to a new address by copying their bytes, without calling their move
+// constructor and destructor.  `DynamicArray` grows these with `reallocate`, which for very large
+// buffers from the default allocator can remap the pages instead of copying them.  True for
+// trivially copyable types.  Specialize it for types that only refer to memory elsewhere and never
+// to themselves.
 template <typename T>
+struct IsTriviallyRelocatable : std::is_trivially_copyable<T> {};
+
+// Memory for the elements comes from `Allocator`, see `MallocAllocator`.
+template <typename T, typename Allocator = MallocAllocator<AllocationTag::DynamicArray>>
 class DynamicArray {
 public:
   using ElementType = T;
@@ -25,8 +38,9 @@ public:
 
   // Factory Methods
 
-  static DynamicArray withInitialCapacity(SizeType initialCapacity) {
-    DynamicArray result;
+  static DynamicArray withInitialCapacity(SizeType initialCapacity,
+                                          const Allocator& allocator = Allocator{}) {
+    DynamicArray result{allocator};
 
     result.ensureAllocated(initialCapacity, DiscardOldData);
 
@@ -34,12 +48,13 @@ public:
   }
 
   static DynamicArray withInitialSize(SizeType initialSize,
-                                      const ElementType& value = ElementType{}) {
-    DynamicArray result;
+                                      const ElementType& value = ElementType{},
+                                      const Allocator& allocator = Allocator{}) {
+    DynamicArray result{allocator};
 
     result.ensureAllocated(initialSize, DiscardOldData);
+    std::uninitialized_fill(result.m_data, result.m_data + initialSize, value);
     result.m_size = initialSize;
-    std::fill(result.m_data, result.m_data + result.m_size, value);
 
     return result;
   }
@@ -48,30 +63,36 @@ public:
 
   DynamicArray() = default;
 
-  DynamicArray(ElementType* data, SizeType size) : m_size{size} {
+  explicit DynamicArray(const Allocator& allocator) : m_allocator{allocator} {}
+
+  DynamicArray(ElementType* data, SizeType size, const Allocator& allocator = Allocator{})
+    : m_allocator{allocator} {
     ensureAllocated(size, DiscardOldData);
     construct_from(data, size);
+    m_size = size;
   }
 
-  DynamicArray(const DynamicArray& other) : m_size{other.m_size} {
-    ensureAllocated(m_size, DiscardOldData);
+  DynamicArray(const DynamicArray& other) : m_allocator{other.m_allocator} {
+    ensureAllocated(other.m_size, DiscardOldData);
     construct_from(other.m_data, other.m_size);
+    m_size = other.m_size;
   }
 
   DynamicArray(DynamicArray&& other) noexcept
-    : m_data{other.m_data}, m_size{other.m_size}, m_capacity{other.m_capacity} {
+    : m_data{other.m_data},
+      m_size{other.m_size},
+      m_capacity{other.m_capacity},
+      m_allocator{std::move(other.m_allocator)} {
     other.m_data = nullptr;
     other.m_size = 0;
     other.m_capacity = 0;
   }
 
-  DynamicArray(std::initializer_list<ElementType> list) : m_size{list.size()} {
+  DynamicArray(std::initializer_list<ElementType> list, const Allocator& allocator = Allocator{})
+    : m_allocator{allocator} {
     ensureAllocated(list.size(), DiscardOldData);
-
-    SizeType index = 0;
-    for (auto& el : list) {
-      new (&m_data[index++]) ElementType{std::move(el)};
-    }
+    construct_from(list.begin(), list.size());
+    m_size = list.size();
   }
 
   ~DynamicArray() {
@@ -81,17 +102,31 @@ public:
   // Operators
 
   DynamicArray& operator=(const DynamicArray& other) {
+    if (this == &other) {
+      return *this;
+    }
+
+    destroy(m_data, m_data + m_size);
+    m_size = 0;
+
     ensureAllocated(other.m_size, DiscardOldData);
-    m_size = other.m_size;
     construct_from(other.m_data, other.m_size);
+    m_size = other.m_size;
 
     return *this;
   }
 
   DynamicArray& operator=(DynamicArray&& other) noexcept {
+    if (this == &other) {
+      return *this;
+    }
+
+    free();
+
     m_data = other.m_data;
     m_size = other.m_size;
     m_capacity = other.m_capacity;
+    m_allocator = std::move(other.m_allocator);
 
     other.m_data = nullptr;
     other.m_size = 0;
@@ -114,6 +149,10 @@ public:
     return m_size == 0;
   }
 
+  const Allocator& allocator() const {
+    return m_allocator;
+  }
+
   // Get
 
   ArrayView<ElementType> view() const {
@@ -189,13 +228,11 @@ public:
 
   // Push back a range of elements.
   void pushBack(ConstIterator begin, ConstIterator end) {
-    ensureAllocated(m_size + end - begin, KeepOldData);
-
-    m_size += end - begin;
+    SizeType count = static_cast<SizeType>(end - begin);
+    ensureAllocated(m_size + count, KeepOldData);
 
-    for (Iterator i = m_data; begin != end;) {
-      new (i++) ElementType(*begin++);
-    }
+    std::uninitialized_copy(begin, end, m_data + m_size);
+    m_size += count;
   }
 
   template <typename... Args>
@@ -227,34 +264,17 @@ public:
   void remove(Iterator pos) {
     DCHECK(pos >= m_data && pos < m_data + m_size) << "Iterator out of bounds.";
 
-    // Destroy the element.
-    pos->~ElementType();
-
-    // If we didn't remove the last item, then move all the items one to the left.
-    if (pos + 1 != m_data + m_size) {
-      for (auto i = pos; i != m_data + (m_size - 1); ++i) {
-        *i = std::move(*(i + 1));
-      }
-    }
-
-    // We have 1 item less now.
-    --m_size;
+    remove(pos, pos + 1);
   }
 
   void remove(Iterator begin, Iterator end) {
-    // Destruct all the elements we are about to remove from the array.
-    for (Iterator e = begin; e != end; ++e) {
-      e->~ElementType();
-    }
+    DCHECK(begin >= m_data && begin <= end && end <= m_data + m_size) << "Range out of bounds.";
 
-    const auto numberOfElementsToRemove = end - begin;
-    if (end < m_data + m_size) {
-      for (auto i = begin; i != m_data + (m_size - numberOfElementsToRemove); ++i) {
-        *i = std::move(*(i + numberOfElementsToRemove));
-      }
-    }
+    // Move the elements after the range to the left, then destroy what is left over at the end.
+    Iterator newEnd = std::move(end, m_data + m_size, begin);
+    destroy(newEnd, m_data + m_size);
 
-    m_size -= numberOfElementsToRemove;
+    m_size = static_cast<SizeType>(newEnd - m_data);
   }
 
   void remove(const ElementType& element) {
@@ -266,11 +286,52 @@ public:
     }
   }
 
+  // Removes the element at `pos` by moving the last element into its place, so the order of the
+  // elements is not kept, but none of the other elements have to move.
+  void swapRemove(Iterator pos) {
+    DCHECK(pos >= m_data && pos < m_data + m_size) << "Iterator out of bounds.";
+
+    Iterator last = m_data + m_size - 1;
+    if (pos != last) {
+      *pos = std::move(*last);
+    }
+    destroy(last, m_data + m_size);
+
+    --m_size;
+  }
+
+  // Removes every element for which `predicate(element)` returns true.  The elements that are left
+  // are moved down in a single pass and keep their order.  Returns the number of elements removed.
+  template <typename Predicate>
+  SizeType removeIf(Predicate predicate) {
+    Iterator end = m_data + m_size;
+    Iterator newEnd = std::remove_if(m_data, end, predicate);
+    destroy(newEnd, end);
+
+    auto removed = static_cast<SizeType>(end - newEnd);
+    m_size -= removed;
+    return removed;
+  }
+
+  // Removes every element equal to `element`, which may not be one of the elements of this array.
+  SizeType removeAll(const ElementType& element) {
+    return removeIf([&element](const ElementType& candidate) {
+      return candidate == element;
+    });
+  }
+
+  // Keeps only the elements for which `predicate(element)` returns true.  Returns the number of
+  // elements removed.
+  template <typename Predicate>
+  SizeType retain(Predicate predicate) {
+    return removeIf([&predicate](const ElementType& element) {
+      return !predicate(element);
+    });
+  }
+
   // Remove all the elements from the array, but keep the current capacity.
   auto removeAll() -> void {
-    for (Iterator it = m_data; it != m_data + m_size; ++it) {
-      it->~ElementType();
-    }
+    destroy(m_data, m_data + m_size);
 
     m_size = 0;
   }
@@ -279,27 +340,47 @@ public:
     ensureAllocated(size, KeepOldData);
   }
 
+  // New elements are value initialized, so numbers are set to 0.
   void resize(SizeType newSize) {
-    ensureAllocated(newSize, KeepOldData);
+    if (newSize < m_size) {
+      destroy(m_data + newSize, m_data + m_size);
+    } else {
+      ensureAllocated(newSize, KeepOldData);
+      std::uninitialized_value_construct(m_data + m_size, m_data + newSize);
+    }
+
     m_size = newSize;
   }
 
   void resize(SizeType newSize, const ElementType& fillValue) {
-    ensureAllocated(newSize, KeepOldData);
-
-    for (SizeType i = m_size; i < newSize; ++i) {
-      m_data[i] = fillValue;
+    if (newSize < m_size) {
+      destroy(m_data + newSize, m_data + m_size);
+    } else {
+      ensureAllocated(newSize, KeepOldData);
+      std::uninitialized_fill(m_data + m_size, m_data + newSize, fillValue);
     }
 
     m_size = newSize;
   }
 
+  // Same as `resize`, but new elements are left uninitialized, for when they are about to be
+  // overwritten anyway, e.g. by reading into them.
+  void resize_uninitialized(SizeType newSize) {
+    static_assert(std::is_trivially_default_constructible_v<ElementType> &&
+                      std::is_trivially_destructible_v<ElementType>,
+                  "Only elements that need no initialization can be left uninitialized.");
+
+    ensureAllocated(newSize, KeepOldData);
+    m_size = newSize;
+  }
+
   void swap(DynamicArray& other) {
     using std::swap;
 
     swap(m_data, other.m_data);
     swap(m_size, other.m_size);
     swap(m_capacity, other.m_capacity);
+    swap(m_allocator, other.m_allocator);
   }
 
   void clear() {
@@ -344,44 +425,59 @@ private:
   void resizeData(MemSize elementsRequired, KeepOld keepOld) {
     DCHECK(m_capacity <= elementsRequired)
         << "The container already has enough space to fit the new elements.";
+    DCHECK(keepOld == KeepOldData || m_size == 0) << "Elements would be lost.";
 
     MemSize bytesRequired = elementsRequired * sizeof(ElementType);
 
-    ElementType* newData = static_cast<ElementType*>(std::malloc(bytesRequired));
+    if constexpr (IsTriviallyRelocatable<ElementType>::value) {
+      // `reallocate` can often grow the buffer in place and large buffers are remapped rather
+      // than copied.
+      if (m_data && keepOld == KeepOldData) {
+        auto* newData = static_cast<ElementType*>(m_allocator.reallocate(
+            m_data, m_capacity * sizeof(ElementType), bytesRequired, alignof(ElementType)));
+        DCHECK(newData) << "Out of memory.";
+        m_data = newData;
+        m_capacity = elementsRequired;
+        return;
+      }
+    }
+
+    auto* newData =
+        static_cast<ElementType*>(m_allocator.allocate(bytesRequired, alignof(ElementType)));
+    DCHECK(newData) << "Out of memory.";
 
-    // If we have old data already in the buffer, then we have to destroy it.  If `keepOld` is set,
-    // then we copy the old data to the new data first.
     if (m_data) {
       if (keepOld == KeepOldData) {
-        for (MemSize i = 0; i < m_capacity; ++i) {
-          newData[i] = std::move(m_data[i]);
-        }
+        std::uninitialized_move(m_data, m_data + m_size, newData);
+        destroy(m_data, m_data + m_size);
       }
 
-      // Free the old data.
-      std::free(m_data);
+      m_allocator.deallocate(m_data, m_capacity * sizeof(ElementType));
     }
 
-    m_capacity = elementsRequired;
     m_data = newData;
+    m_capacity = elementsRequired;
   }
 
-  void construct_from(T* source, SizeType source_size) {
+  static void destroy(ElementType* begin, ElementType* end) {
+    if constexpr (!std::is_trivially_destructible_v<ElementType>) {
+      for (ElementType* element = begin; element != end; ++element) {
+        element->~ElementType();
+      }
+    }
+  }
+
+  void construct_from(const T* source, SizeType source_size) {
     DCHECK(m_capacity >= source_size);
 
-    for (SizeType i = 0; i < source_size; ++i) {
-      new (&m_data[i]) T{source[i]};
-    }
+    std::uninitialized_copy(source, source + source_size, m_data);
   }
 
   void free() {
     if (m_data) {
-      // Destruct all the objects we contain.
-      for (ElementType* el = m_data; el != m_data + m_size; ++el) {
-        el->~ElementType();
-      }
+      destroy(m_data, m_data + m_size);
 
-      std::free(m_data);
+      m_allocator.deallocate(m_data, m_capacity * sizeof(ElementType));
       m_data = nullptr;
     }
 
@@ -397,12 +493,18 @@ private:
 
   // Total amount of elements currently allocated.
   MemSize m_capacity = 0;
+
+  NU_NO_UNIQUE_ADDRESS Allocator m_allocator;
 };
 
+// Only the pointer to the elements moves, the elements themselves stay where they are.
+template <typename T, typename Allocator>
+struct IsTriviallyRelocatable<DynamicArray<T, Allocator>> : IsTriviallyRelocatable<Allocator> {};
+
 }  // namespace nu
 
-template <typename T>
-std::ostream& operator<<(std::ostream& os, const nu::DynamicArray<T>& value) {
+template <typename T, typename Allocator>
+std::ostream& operator<<(std::ostream& os, const nu::DynamicArray<T, Allocator>& value) {
   os << '[';
   auto size = value.size();
   for (auto it = value.begin(), eit = value.end(); it != eit; ++it) {
@@ -0,0 +1,418 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <type_traits>
+
+#include "nucleus/containers/array_view.h"
+#include "nucleus/containers/dynamic_array.h"
+#include "nucleus/containers/hash_map.h"
+#include "nucleus/hash.h"
+#include "nucleus/logging.h"
+#include "nucleus/streams/output_stream.h"
+
+namespace nu {
+
+namespace detail {
+
+// The header at the start of a serialized `FrozenHashMap`, followed by a `U32` pilot for each
+// bucket and, from `entries_offset`, the entries.  Everything is stored in the byte order of the
+// machine that wrote it; the magic number does not match when it is read on the other kind.
+struct FrozenHashMapHeader {
+  static constexpr U32 MAGIC = 0x48465A4E;  // "NZFH"
+  static constexpr U32 VERSION = 2;
+
+  U32 magic;
+  U32 version;
+  U32 key_size;
+  U32 value_size;
+  U64 seed;
+  U32 entry_count;
+  U32 bucket_count;
+  U64 entries_offset;
+};
+
+static_assert(sizeof(FrozenHashMapHeader) == 40, "The header is part of the file format.");
+
+constexpr U64 frozen_mix(U64 value) {
+  value ^= value >> 30;
+  value *= 0xBF58476D1CE4E5B9ull;
+  value ^= value >> 27;
+  value *= 0x94D049BB133111EBull;
+  value ^= value >> 31;
+  return value;
+}
+
+// Hashes the bytes of a key to 64 bits.  32-bit hashes of millions of keys collide, and keys with
+// the same hash can never be told apart by a perfect hash.
+inline U64 frozen_key_hash(const void* data, MemSize size, U64 seed) {
+  return hash_bytes(static_cast<const char*>(data), size, seed);
+}
+
+// Maps a 32-bit value onto [0, range) without a division.
+constexpr U32 frozen_reduce(U64 value, U32 range) {
+  return static_cast<U32>(((value & 0xFFFFFFFF) * range) >> 32);
+}
+
+}  // namespace detail
+
+// An immutable map built with a minimal perfect hash ("hash and displace").  Keys are spread over
+// buckets of about four keys each, and every bucket stores a pilot that places all of its keys on
+// distinct entries, so `n` keys take exactly `n` entries and a lookup reads one pilot and one
+// entry.
+//
+// The map is built once and written to an `OutputStream`.  The written bytes do not contain
+// pointers, so they can be loaded in place from any `ArrayView<U8>`, e.g. a memory-mapped file,
+// without copying or rebuilding anything.  Keys and values are stored as raw bytes, so they have to
+// be trivially copyable.
+template <typename KeyType, typename ValueType>
+class FrozenHashMap {
+public:
+  static_assert(std::is_trivially_copyable_v<KeyType> && std::is_trivially_copyable_v<ValueType>,
+                "Keys and values are stored as raw bytes.");
+  static_assert(std::has_unique_object_representations_v<KeyType>,
+                "Keys are hashed as raw bytes, so they can not have padding.");
+
+  using ItemType = HashMapItem<KeyType, ValueType>;
+
+  // Builds the map from `items`, which must all have different keys, and writes it to `stream`.
+  // Returns false if the map could not be built.
+  static bool write(OutputStream* stream, ArrayView<ItemType> items);
+
+  static bool write(OutputStream* stream, const HashMap<KeyType, ValueType>& map) {
+    auto items = DynamicArray<ItemType>::withInitialCapacity(map.size());
+    for (auto& item : map) {
+      items.pushBack(item);
+    }
+    return write(stream, items.view());
+  }
+
+  FrozenHashMap() = default;
+
+  // Use the map stored in `data`, which has to stay alive and unchanged for as long as the map is
+  // used.  `data` must be aligned like the entries, which memory-mapped files always are.  Returns
+  // false if `data` does not hold a map with these key and value types.
+  bool load(ArrayView<U8> data);
+
+  NU_NO_DISCARD MemSize size() const {
+    return entry_count_;
+  }
+
+  NU_NO_DISCARD bool empty() const {
+    return entry_count_ == 0;
+  }
+
+  class FindResult {
+  public:
+    bool was_found() const {
+      return item_ != nullptr;
+    }
+
+    const KeyType& key() const {
+      DCHECK(item_);
+      return item_->key;
+    }
+
+    const ValueType& value() const {
+      DCHECK(item_);
+      return item_->value;
+    }
+
+  private:
+    friend class FrozenHashMap;
+
+    explicit FindResult(const ItemType* item) : item_{item} {}
+
+    const ItemType* item_;
+  };
+
+  FindResult find(const KeyType& key) const {
+    if (entry_count_ == 0) {
+      return FindResult{nullptr};
+    }
+
+    U64 hash = detail::frozen_key_hash(&key, sizeof(KeyType), seed_);
+    U32 slot = slot_for(hash, pilots_[bucket_for(hash, bucket_count_)], entry_count_);
+    DCHECK(slot < entry_count_);
+    auto& item = entries_[slot];
+    return FindResult{item.key == key ? &item : nullptr};
+  }
+
+  bool contains_key(const KeyType& key) const {
+    return find(key).was_found();
+  }
+
+  // Iterates all entries, in no particular order.
+  const ItemType* begin() const {
+    return entries_;
+  }
+
+  const ItemType* end() const {
+    return entries_ + entry_count_;
+  }
+
+private:
+  // Average number of keys per bucket.  More keys per bucket make the pilots smaller, but finding
+  // them slower.
+  static constexpr U32 KEYS_PER_BUCKET = 4;
+
+  // Buckets with a single key store the index of its entry instead of a pilot.
+  static constexpr U32 DIRECT_PILOT = 0x80000000;
+
+  // Give up on a seed when a bucket needs more pilots than this and start over with a new one.
+  static constexpr U32 MAX_PILOT = 1u << 20;
+  static constexpr U32 MAX_SEEDS = 16;
+
+  static U32 bucket_for(U64 hash, U32 bucket_count) {
+    return detail::frozen_reduce(hash >> 32, bucket_count);
+  }
+
+  static U32 slot_for(U64 hash, U32 pilot, U32 entry_count) {
+    if (pilot & DIRECT_PILOT) {
+      return pilot & ~DIRECT_PILOT;
+    }
+    return detail::frozen_reduce(detail::frozen_mix(hash ^ detail::frozen_mix(pilot)), entry_count);
+  }
+
+  static bool find_pilots(ArrayView<ItemType> items, U64 seed, U32 bucket_count,
+                          DynamicArray<U32>* pilots, DynamicArray<U32>* slot_items);
+
+  U64 seed_ = 0;
+  U32 entry_count_ = 0;
+  U32 bucket_count_ = 0;
+  const U32* pilots_ = nullptr;
+  const ItemType* entries_ = nullptr;
+};
+
+// static
+template <typename KeyType, typename ValueType>
+bool FrozenHashMap<KeyType, ValueType>::write(OutputStream* stream, ArrayView<ItemType> items) {
+  if (items.size() >= DIRECT_PILOT) {
+    LOG(Error) << "Too many items for a frozen hash map.";
+    return false;
+  }
+
+  auto entry_count = static_cast<U32>(items.size());
+  U32 bucket_count = std::max<U32>(1, (entry_count + KEYS_PER_BUCKET - 1) / KEYS_PER_BUCKET);
+
+  DynamicArray<U32> pilots;
+  DynamicArray<U32> slot_items;
+  U64 seed = 0;
+  for (;; ++seed) {
+    if (seed == MAX_SEEDS) {
+      LOG(Error) << "Could not build a frozen hash map, are all the keys different?";
+      return false;
+    }
+
+    if (find_pilots(items, seed, bucket_count, &pilots, &slot_items)) {
+      break;
+    }
+  }
+
+  MemSize entries_start = sizeof(detail::FrozenHashMapHeader) + sizeof(U32) * bucket_count;
+  MemSize alignment = std::max<MemSize>(alignof(ItemType), 8);
+  MemSize entries_offset = (entries_start + alignment - 1) / alignment * alignment;
+
+  detail::FrozenHashMapHeader header = {};
+  header.magic = detail::FrozenHashMapHeader::MAGIC;
+  header.version = detail::FrozenHashMapHeader::VERSION;
+  header.key_size = sizeof(KeyType);
+  header.value_size = sizeof(ValueType);
+  header.seed = seed;
+  header.entry_count = entry_count;
+  header.bucket_count = bucket_count;
+  header.entries_offset = entries_offset;
+
+  // A short write would leave a truncated map behind, so every write has to go through in full.
+  auto write_all = [stream](const void* buffer, MemSize size) {
+    if (stream->write(buffer, size) != size) {
+      LOG(Error) << "Could not write the frozen hash map to the stream.";
+      return false;
+    }
+    return true;
+  };
+
+  if (!write_all(&header, sizeof(header)) ||
+      !write_all(pilots.data(), sizeof(U32) * bucket_count)) {
+    return false;
+  }
+
+  U8 padding[alignof(ItemType) + 8] = {};
+  if (!write_all(padding, entries_offset - entries_start)) {
+    return false;
+  }
+
+  // Entries are put together in a zeroed buffer, so the padding around the key and the value is
+  // written as zeros instead of whatever happened to be in memory.
+  alignas(ItemType) U8 entry[sizeof(ItemType)];
+  for (U32 slot = 0; slot < entry_count; ++slot) {
+    const ItemType& item = items.data()[slot_items[slot]];
+    std::memset(entry, 0, sizeof(entry));
+    std::memcpy(entry + offsetof(ItemType, key), &item.key, sizeof(KeyType));
+    std::memcpy(entry + offsetof(ItemType, value), &item.value, sizeof(ValueType));
+
+    if (!write_all(entry, sizeof(entry))) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+// static
+template <typename KeyType, typename ValueType>
+bool FrozenHashMap<KeyType, ValueType>::find_pilots(ArrayView<ItemType> items, U64 seed,
+                                                    U32 bucket_count, DynamicArray<U32>* pilots,
+                                                    DynamicArray<U32>* slot_items) {
+  auto entry_count = static_cast<U32>(items.size());
+
+  DynamicArray<U64> hashes;
+  hashes.resize(entry_count);
+  for (U32 i = 0; i < entry_count; ++i) {
+    hashes[i] = detail::frozen_key_hash(&items.data()[i].key, sizeof(KeyType), seed);
+  }
+
+  // Sort the items by bucket, with a counting sort.
+  DynamicArray<U32> bucket_starts;
+  bucket_starts.resize(bucket_count + 1, 0);
+  for (U32 i = 0; i < entry_count; ++i) {
+    ++bucket_starts[bucket_for(hashes[i], bucket_count) + 1];
+  }
+  for (U32 b = 0; b < bucket_count; ++b) {
+    bucket_starts[b + 1] += bucket_starts[b];
+  }
+
+  DynamicArray<U32> bucket_items;
+  bucket_items.resize(entry_count);
+  {
+    DynamicArray<U32> next = bucket_starts;
+    for (U32 i = 0; i < entry_count; ++i) {
+      bucket_items[next[bucket_for(hashes[i], bucket_count)]++] = i;
+    }
+  }
+
+  // Large buckets are placed first, while there are still plenty of free entries.
+  DynamicArray<U32> order;
+  order.resize(bucket_count);
+  for (U32 b = 0; b < bucket_count; ++b) {
+    order[b] = b;
+  }
+  std::stable_sort(order.begin(), order.end(), [&](U32 left, U32 right) {
+    return bucket_starts[left + 1] - bucket_starts[left] >
+           bucket_starts[right + 1] - bucket_starts[right];
+  });
+
+  pilots->resize(bucket_count, 0);
+  slot_items->resize(entry_count, 0);
+
+  DynamicArray<U8> taken;
+  taken.resize(entry_count, 0);
+
+  U32 slots[64];
+  U32 next_free_slot = 0;
+
+  for (U32 bucket : order) {
+    U32 first = bucket_starts[bucket];
+    U32 size = bucket_starts[bucket + 1] - first;
+    if (size == 0) {
+      break;
+    }
+
+    if (size == 1) {
+      while (taken[next_free_slot]) {
+        ++next_free_slot;
+      }
+      taken[next_free_slot] = 1;
+      (*pilots)[bucket] = DIRECT_PILOT | next_free_slot;
+      (*slot_items)[next_free_slot] = bucket_items[first];
+      continue;
+    }
+
+    if (size > sizeof(slots) / sizeof(slots[0])) {
+      return false;
+    }
+
+    U32 pilot = 0;
+    for (;; ++pilot) {
+      if (pilot == MAX_PILOT) {
+        return false;
+      }
+
+      bool fits = true;
+      for (U32 i = 0; i < size && fits; ++i) {
+        slots[i] = slot_for(hashes[bucket_items[first + i]], pilot, entry_count);
+        fits = !taken[slots[i]] && std::find(slots, slots + i, slots[i]) == slots + i;
+      }
+
+      if (fits) {
+        break;
+      }
+    }
+
+    (*pilots)[bucket] = pilot;
+    for (U32 i = 0; i < size; ++i) {
+      taken[slots[i]] = 1;
+      (*slot_items)[slots[i]] = bucket_items[first + i];
+    }
+  }
+
+  return true;
+}
+
+template <typename KeyType, typename ValueType>
+bool FrozenHashMap<KeyType, ValueType>::load(ArrayView<U8> data) {
+  detail::FrozenHashMapHeader header;
+  if (data.size() < sizeof(header)) {
+    LOG(Error) << "Frozen hash map data is too small.";
+    return false;
+  }
+  std::memcpy(&header, data.data(), sizeof(header));
+
+  if (header.magic != detail::FrozenHashMapHeader::MAGIC ||
+      header.version != detail::FrozenHashMapHeader::VERSION) {
+    LOG(Error) << "Data does not contain a frozen hash map.";
+    return false;
+  }
+
+  if (header.key_size != sizeof(KeyType) || header.value_size != sizeof(ValueType)) {
+    LOG(Error) << "Frozen hash map was written with different key or value types.";
+    return false;
+  }
+
+  // Written so that none of the sizes can wrap around, whatever is in the header.
+  if (header.bucket_count == 0 ||
+      header.entries_offset < sizeof(header) + sizeof(U32) * header.bucket_count ||
+      header.entries_offset > data.size() ||
+      header.entry_count > (data.size() - header.entries_offset) / sizeof(ItemType)) {
+    LOG(Error) << "Frozen hash map data is truncated.";
+    return false;
+  }
+
+  if (reinterpret_cast<MemSize>(data.data()) % std::max<MemSize>(alignof(ItemType), 8) != 0 ||
+      header.entries_offset % alignof(ItemType) != 0) {
+    LOG(Error) << "Frozen hash map data is not aligned.";
+    return false;
+  }
+
+  // Lookups use pilots without checking them, so a pilot that points past the entries would make
+  // `find` read outside of the data.
+  auto* pilots = reinterpret_cast<const U32*>(data.data() + sizeof(header));
+  for (U32 bucket = 0; bucket < header.bucket_count; ++bucket) {
+    if ((pilots[bucket] & DIRECT_PILOT) &&
+        (pilots[bucket] & ~DIRECT_PILOT) >= header.entry_count) {
+      LOG(Error) << "Frozen hash map data is corrupt.";
+      return false;
+    }
+  }
+
+  seed_ = header.seed;
+  entry_count_ = header.entry_count;
+  bucket_count_ = header.bucket_count;
+  pilots_ = pilots;
+  entries_ = reinterpret_cast<const ItemType*>(data.data() + header.entries_offset);
+
+  return true;
+}
+
+}  // namespace nu
@@ -1,5 +1,10 @@
 #pragma once
 
+#include <initializer_list>
+#include <new>
+#include <type_traits>
+#include <utility>
+
 #include "nucleus/containers/hash_table.h"
 
 namespace nu {
@@ -14,12 +19,12 @@ struct HashMapItem {
   }
 };
 
-template <typename KeyType, typename ValueType>
+template <typename KeyType, typename ValueType, template <typename> class Hasher = Hash>
 struct HashMapItemTraits {
   using ItemType = HashMapItem<KeyType, ValueType>;
 
   static HashedValue hashed(const ItemType& item) {
-    return Hash<KeyType>::hashed(item.key);
+    return Hasher<KeyType>::hashed(item.key);
   }
 
   static bool equals(const ItemType& left, const ItemType& right) {
@@ -27,14 +32,38 @@ struct HashMapItemTraits {
   }
 };
 
-template <typename KeyType, typename ValueType>
+// Keys are hashed with `Hasher<KeyType>`.  Use `SeededHash` for maps keyed by data that comes from
+// outside of the process.
+template <typename KeyType, typename ValueType, typename ProbingPolicy = GroupProbing,
+          template <typename> class Hasher = Hash,
+          typename Allocator = MallocAllocator<AllocationTag::HashTable>>
 class HashMap
-  : public HashTableBase<HashMapItem<KeyType, ValueType>, HashMapItemTraits<KeyType, ValueType>> {
+  : public HashTableBase<HashMapItem<KeyType, ValueType>,
+                         HashMapItemTraits<KeyType, ValueType, Hasher>, ProbingPolicy, Allocator> {
+  using Base = HashTableBase<HashMapItem<KeyType, ValueType>,
+                             HashMapItemTraits<KeyType, ValueType, Hasher>, ProbingPolicy,
+                             Allocator>;
+
 public:
   using ItemType = HashMapItem<KeyType, ValueType>;
 
   HashMap() = default;
 
+  explicit HashMap(const Allocator& allocator) : Base{allocator} {}
+
+  // The map is sized for all the items up front, so it never grows while they are inserted.
+  explicit HashMap(ArrayView<ItemType> items) {
+    insert_all(items.data(), items.data() + items.size(), items.size());
+  }
+
+  HashMap(std::initializer_list<ItemType> items) {
+    insert_all(items.begin(), items.end(), items.size());
+  }
+
+  HashMap(const HashMap& other) = default;
+
+  HashMap& operator=(const HashMap& other) = default;
+
   class InsertResult {
   public:
     NU_NO_DISCARD bool is_new() const {
@@ -60,29 +89,114 @@ public:
     ValueType* value_;
   };
 
+  // Inserting a key that is already in the map assigns the new value to the existing item.
   InsertResult insert(const KeyType& key, ValueType value) {
-    auto hash = Hash<KeyType>::hashed(key);
-    auto* bucket = this->find_bucket_for_writing(hash, [&](ItemType& i) {
-      return i.key == key;
-    });
-    DCHECK(bucket) << "Could not find a bucket for writing.";
+    return insert_with_hash(Hasher<KeyType>::hashed(key), key, std::move(value));
+  }
+
+  InsertResult insert(KeyType&& key, ValueType value) {
+    auto hash = Hasher<KeyType>::hashed(key);
+    return insert_with_hash(hash, std::move(key), std::move(value));
+  }
 
-    bool is_new = !bucket->is_used();
+  // Same as `insert`, but with the hash of `key` already calculated.
+  InsertResult insert_with_hash(HashedValue hash, const KeyType& key, ValueType value) {
+    return insert_or_assign_with_hash(hash, key, std::move(value));
+  }
 
-    auto item = ItemType{key, std::move(value)};
-    bucket->set(std::move(item));
+  InsertResult insert_with_hash(HashedValue hash, KeyType&& key, ValueType value) {
+    return insert_or_assign_with_hash(hash, std::move(key), std::move(value));
+  }
+
+  // Assigns `value` to the item if `key` is already in the map, otherwise the item is constructed
+  // in place from `key` and `value`.
+  template <typename M>
+  InsertResult insert_or_assign(const KeyType& key, M&& value) {
+    return insert_or_assign_with_hash(Hasher<KeyType>::hashed(key), key, std::forward<M>(value));
+  }
 
-    if (is_new) {
-      ++this->size_;
+  template <typename M>
+  InsertResult insert_or_assign(KeyType&& key, M&& value) {
+    auto hash = Hasher<KeyType>::hashed(key);
+    return insert_or_assign_with_hash(hash, std::move(key), std::forward<M>(value));
+  }
+
+  // The key is only converted to a `KeyType` if it is not in the map yet.
+  template <typename LookupType, typename M,
+            typename = EnableIfHashCompatible<KeyType, LookupType>>
+  InsertResult insert_or_assign(const LookupType& key, M&& value) {
+    return insert_or_assign_with_hash(Hasher<LookupType>::hashed(key), key, std::forward<M>(value));
+  }
+
+  // Same as `insert_or_assign`, but with the hash of `key` already calculated.
+  template <typename K, typename M>
+  InsertResult insert_or_assign_with_hash(HashedValue hash, K&& key, M&& value) {
+    auto bucket = find_bucket_for_key(hash, key);
+
+    if (bucket.is_used()) {
+      auto& item = bucket.reference();
+      item.value = std::forward<M>(value);
+      return {false, &item.key, &item.value};
     }
 
-    return {is_new, &bucket->reference().key, &bucket->reference().value};
+    return construct_in(bucket, std::forward<K>(key), std::forward<M>(value));
+  }
+
+  // Constructs the value from `args` if `key` is not in the map yet.  Nothing is constructed,
+  // copied or moved if it is, so move-only arguments are left alone.
+  template <typename... Args>
+  InsertResult try_emplace(const KeyType& key, Args&&... args) {
+    return try_emplace_with_hash(Hasher<KeyType>::hashed(key), key, std::forward<Args>(args)...);
+  }
+
+  template <typename... Args>
+  InsertResult try_emplace(KeyType&& key, Args&&... args) {
+    auto hash = Hasher<KeyType>::hashed(key);
+    return try_emplace_with_hash(hash, std::move(key), std::forward<Args>(args)...);
+  }
+
+  // The key is only converted to a `KeyType` if it is not in the map yet, so looking up a
+  // `DynamicString` key with a `StringView` only allocates for new items.
+  template <typename LookupType, typename = EnableIfHashCompatible<KeyType, LookupType>,
+            typename... Args>
+  InsertResult try_emplace(const LookupType& key, Args&&... args) {
+    return try_emplace_with_hash(Hasher<LookupType>::hashed(key), key, std::forward<Args>(args)...);
+  }
+
+  // Same as `try_emplace`, but with the hash of `key` already calculated.
+  template <typename K, typename... Args>
+  InsertResult try_emplace_with_hash(HashedValue hash, K&& key, Args&&... args) {
+    auto bucket = find_bucket_for_key(hash, key);
+
+    if (bucket.is_used()) {
+      auto& item = bucket.reference();
+      return {false, &item.key, &item.value};
+    }
+
+    return construct_in(bucket, std::forward<K>(key), std::forward<Args>(args)...);
+  }
+
+  // Constructs the item from `args` and moves it into the map if its key is not in the map yet.
+  // The item is built before its key can be looked up, so prefer `try_emplace` when the key is
+  // likely to be in the map already.
+  template <typename... Args>
+  InsertResult emplace(Args&&... args) {
+    ItemType item{std::forward<Args>(args)...};
+    auto hash = Hasher<KeyType>::hashed(item.key);
+    return try_emplace_with_hash(hash, std::move(item.key), std::move(item.value));
   }
 
   bool contains_key(const KeyType& key) const {
     return find(key).was_found();
   }
 
+  // Look up a key with a different type that hashes and compares equal to it, see
+  // `IsHashCompatible`.
+  template <typename LookupType, typename = EnableIfHashCompatible<KeyType, LookupType>>
+  bool contains_key(const LookupType& key) const {
+    return find(key).was_found();
+  }
+
   class FindResult {
   public:
     bool was_found() const {
@@ -100,7 +214,7 @@ public:
     }
 
   private:
-    friend class HashMap<KeyType, ValueType>;
+    friend class HashMap;
 
     FindResult(bool was_found, KeyType* key, ValueType* value)
       : was_found_{was_found}, key_{key}, value_{value} {}
@@ -111,15 +225,127 @@ public:
   };
 
   FindResult find(const KeyType& key) const {
-    auto* bucket = this->find_bucket_for_reading(Hash<KeyType>::hashed(key), [&](ItemType& item) {
+    return find_with_hash(Hasher<KeyType>::hashed(key), key);
+  }
+
+  template <typename LookupType, typename = EnableIfHashCompatible<KeyType, LookupType>>
+  FindResult find(const LookupType& key) const {
+    return find_with_hash(Hasher<LookupType>::hashed(key), key);
+  }
+
+  // Same as `find`, but with the hash of `key` already calculated.
+  template <typename LookupType>
+  FindResult find_with_hash(HashedValue hash, const LookupType& key) const {
+    static_assert(
+        std::is_same_v<KeyType, LookupType> || IsHashCompatible<KeyType, LookupType>::value,
+        "Lookup type is not hash compatible with the key type.");
+    DCHECK(hash == Hasher<LookupType>::hashed(key)) << "Hash does not match the key.";
+
+    auto bucket = this->find_bucket_for_reading(hash, [&](ItemType& item) {
       return item.key == key;
     });
     if (bucket) {
-      return {true, &bucket->reference().key, &bucket->reference().value};
+      return {true, &bucket.reference().key, &bucket.reference().value};
     }
 
     return {false, nullptr, nullptr};
   }
+
+  // Look up a batch of keys at once, which is a lot faster than calling `find` for each of them
+  // when the map does not fit in the cache.  `callback` is called with the index of each key and
+  // its `FindResult`, in order.
+  template <typename LookupType, typename Callback>
+  void find_many(ArrayView<LookupType> keys, Callback&& callback) const {
+    static_assert(
+        std::is_same_v<KeyType, LookupType> || IsHashCompatible<KeyType, LookupType>::value,
+        "Lookup type is not hash compatible with the key type.");
+
+    this->find_buckets_for_reading(
+        keys, &Hasher<LookupType>::hashed,
+        [](ItemType& item, const LookupType& key) {
+          return item.key == key;
+        },
+        [&](MemSize index, auto bucket) {
+          if (bucket) {
+            callback(index, FindResult{true, &bucket.reference().key, &bucket.reference().value});
+          } else {
+            callback(index, FindResult{false, nullptr, nullptr});
+          }
+        });
+  }
+
+  // Returns true if the key was found and removed from the map.
+  bool remove(const KeyType& key) {
+    return remove_with_hash(Hasher<KeyType>::hashed(key), key);
+  }
+
+  template <typename LookupType, typename = EnableIfHashCompatible<KeyType, LookupType>>
+  bool remove(const LookupType& key) {
+    return remove_with_hash(Hasher<LookupType>::hashed(key), key);
+  }
+
+  // Same as `remove`, but with the hash of `key` already calculated.
+  template <typename LookupType>
+  bool remove_with_hash(HashedValue hash, const LookupType& key) {
+    static_assert(
+        std::is_same_v<KeyType, LookupType> || IsHashCompatible<KeyType, LookupType>::value,
+        "Lookup type is not hash compatible with the key type.");
+    DCHECK(hash == Hasher<LookupType>::hashed(key)) << "Hash does not match the key.";
+
+    auto bucket = this->find_bucket_for_reading(hash, [&](ItemType& item) {
+      return item.key == key;
+    });
+    if (!bucket) {
+      return false;
+    }
+
+    this->erase_bucket(bucket);
+
+    return true;
+  }
+
+private:
+  using Bucket = typename Base::Bucket;
+
+  template <typename LookupType>
+  Bucket find_bucket_for_key(HashedValue hash, const LookupType& key) {
+    DCHECK(hash == Hasher<LookupType>::hashed(key)) << "Hash does not match the key.";
+
+    auto bucket = this->find_bucket_for_writing(hash, [&](ItemType& item) {
+      return item.key == key;
+    });
+    DCHECK(bucket) << "Could not find a bucket for writing.";
+
+    return bucket;
+  }
+
+  // Builds the key and the value straight in the bucket, without a temporary item.
+  template <typename K, typename... Args>
+  InsertResult construct_in(Bucket& bucket, K&& key, Args&&... args) {
+    bucket.construct_with([&](void* memory) {
+      new (memory) ItemType{KeyType(std::forward<K>(key)), ValueType(std::forward<Args>(args)...)};
+    });
+    ++this->size_;
+
+    auto& item = bucket.reference();
+    return {true, &item.key, &item.value};
+  }
+
+  void insert_all(const ItemType* begin, const ItemType* end, MemSize count) {
+    this->reserve(count);
+    for (auto* item = begin; item != end; ++item) {
+      auto bucket = this->find_bucket_for_writing_reserved(
+          Hasher<KeyType>::hashed(item->key), [&](ItemType& existing) {
+            return existing.key == item->key;
+          });
+
+      if (bucket.is_used()) {
+        bucket.reference().value = item->value;
+      } else {
+        construct_in(bucket, item->key, item->value);
+      }
+    }
+  }
 };
 
 }  // namespace nu
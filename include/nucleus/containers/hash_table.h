@@ -1,6 +1,8 @@
 #pragma once
 
 #include <cstring>
+#include <initializer_list>
+#include <type_traits>
 
 #include "nucleus/containers/hash_table_base.h"
 #include "nucleus/hash.h"
@@ -10,34 +12,45 @@
 
 namespace nu {
 
-// Implementation of a hash table using linear probing for resolving collisions.
-template <typename T>
-class HashTable : public HashTableBase<T> {
+// Implementation of a hash table using open addressing, see `HashTableBase`.  Items are hashed
+// with `Hasher<T>`, see `SeededHash` for tables holding data that comes from outside of the
+// process.
+template <typename T, typename ProbingPolicy = GroupProbing,
+          template <typename> class Hasher = Hash,
+          typename Allocator = MallocAllocator<AllocationTag::HashTable>>
+class HashTable
+  : public HashTableBase<T, DefaultHashTableBaseTraits<T, Hasher>, ProbingPolicy, Allocator> {
+  using Base = HashTableBase<T, DefaultHashTableBaseTraits<T, Hasher>, ProbingPolicy, Allocator>;
+
 public:
   HashTable() = default;
 
-  HashTable(const HashTable& other) {
-    for (auto& other_item : other) {
-      insert(other_item);
-    }
+  explicit HashTable(const Allocator& allocator) : Base{allocator} {}
+
+  // The table is sized for all the items up front, so it never grows while they are inserted.
+  explicit HashTable(ArrayView<T> items) {
+    insert_all(items.data(), items.data() + items.size(), items.size());
   }
 
+  HashTable(std::initializer_list<T> items) {
+    insert_all(items.begin(), items.end(), items.size());
+  }
+
+  HashTable(const HashTable& other) = default;
+
   ~HashTable() = default;
 
-  HashTable& operator=(const HashTable& other) {
-    this->clear();
-    for (auto& other_item : other) {
-      insert(other_item);
-    }
+  HashTable& operator=(const HashTable& other) = default;
 
-    return *this;
+  bool contains(const T& item) const {
+    return find_with_hash(Hasher<T>::hashed(item), item).was_found();
   }
 
-  bool contains(const T& item) const {
-    auto hash = Hash<T>::hashed(item);
-    return this->find_bucket_for_reading(hash, [&](T& t) {
-      return item == t;
-    }) != nullptr;
+  // Look up an item with a different type that hashes and compares equal to it, see
+  // `IsHashCompatible`.
+  template <typename LookupType, typename = EnableIfHashCompatible<T, LookupType>>
+  bool contains(const LookupType& item) const {
+    return find_with_hash(Hasher<LookupType>::hashed(item), item).was_found();
   }
 
   class FindResult {
@@ -52,7 +65,7 @@ public:
     }
 
   private:
-    friend class HashTable<T>;
+    friend class HashTable;
 
     FindResult(bool found, T* item) : found_{found}, item_{item} {}
 
@@ -60,27 +73,63 @@ public:
     T* item_;
   };
 
-  FindResult find(const T& item) {
-    auto* bucket = find_bucket_for_reading(Hash<T>::hashed(item), [&](T& t) {
-      return t == item;
-    });
-    if (bucket) {
-      return {true, bucket->pointer()};
-    }
+  FindResult find(const T& item) const {
+    return find_with_hash(Hasher<T>::hashed(item), item);
+  }
 
-    return {false, nullptr};
+  template <typename LookupType, typename = EnableIfHashCompatible<T, LookupType>>
+  FindResult find(const LookupType& item) const {
+    return find_with_hash(Hasher<LookupType>::hashed(item), item);
   }
 
   template <typename Predicate>
-  FindResult find(HashedValue hash, Predicate predicate) {
-    auto* bucket = find_bucket_for_reading(hash, predicate);
+  FindResult find(HashedValue hash, Predicate predicate) const {
+    auto bucket = this->find_bucket_for_reading(hash, predicate);
     if (bucket) {
-      return {true, bucket->pointer()};
+      return {true, bucket.pointer()};
     }
 
     return {false, nullptr};
   }
 
+  // Same as `find`, but with the hash of `item` already calculated.
+  template <typename LookupType>
+  FindResult find_with_hash(HashedValue hash, const LookupType& item) const {
+    static_assert(std::is_same_v<T, LookupType> || IsHashCompatible<T, LookupType>::value,
+                  "Lookup type is not hash compatible with the item type.");
+    DCHECK(hash == Hasher<LookupType>::hashed(item)) << "Hash does not match the item.";
+
+    return find(hash, [&](T& t) {
+      return t == item;
+    });
+  }
+
+  // Look up a batch of items at once, which is a lot faster than calling `find` for each of them
+  // when the table does not fit in the cache.  `callback` is called with the index of each item and
+  // its `FindResult`, in order.
+  template <typename LookupType, typename Callback>
+  void find_many(ArrayView<LookupType> items, Callback&& callback) const {
+    static_assert(std::is_same_v<T, LookupType> || IsHashCompatible<T, LookupType>::value,
+                  "Lookup type is not hash compatible with the item type.");
+
+    this->find_buckets_for_reading(
+        items, &Hasher<LookupType>::hashed,
+        [](T& t, const LookupType& item) {
+          return t == item;
+        },
+        [&](MemSize index, auto bucket) {
+          callback(index, bucket ? FindResult{true, bucket.pointer()} : FindResult{false, nullptr});
+        });
+  }
+
+  // Same as `find_many`, but `callback` is called with whether each item is in the table.
+  template <typename LookupType, typename Callback>
+  void contains_many(ArrayView<LookupType> items, Callback&& callback) const {
+    find_many(items, [&](MemSize index, FindResult result) {
+      callback(index, result.was_found());
+    });
+  }
+
   class InsertResult {
   public:
     NU_NO_DISCARD bool is_new() const {
@@ -92,7 +141,7 @@ public:
     }
 
   private:
-    friend class HashTable<T>;
+    friend class HashTable;
 
     InsertResult(bool is_new, T* item) : is_new_{is_new}, item_{item} {}
 
@@ -101,61 +150,101 @@ public:
   };
 
   InsertResult insert(const T& item) {
-    auto hash = Hash<T>::hashed(item);
-    auto* bucket = this->find_bucket_for_writing(hash, [&](T& t) {
+    return insert_with_hash(Hasher<T>::hashed(item), item);
+  }
+
+  InsertResult insert(T&& item) {
+    auto hash = Hasher<T>::hashed(item);
+    return insert_with_hash(hash, std::move(item));
+  }
+
+  // Same as `insert`, but with the hash of `item` already calculated.
+  InsertResult insert_with_hash(HashedValue hash, const T& item) {
+    DCHECK(hash == Hasher<T>::hashed(item)) << "Hash does not match the item.";
+
+    auto bucket = this->find_bucket_for_writing(hash, [&](T& t) {
       return item == t;
     });
     DCHECK(bucket) << "Could not find a bucket for writing.";
 
-    bool is_new = !bucket->is_used();
+    bool is_new = !bucket.is_used();
 
-    bucket->set(item);
+    bucket.set(item);
 
     if (is_new) {
       ++this->size_;
     }
 
-    return {is_new, bucket->pointer()};
+    return {is_new, bucket.pointer()};
   }
 
-  InsertResult insert(T&& item) {
-    auto hash = Hash<T>::hashed(item);
-    auto* bucket = this->find_bucket_for_writing(hash, [&](T& t) {
+  InsertResult insert_with_hash(HashedValue hash, T&& item) {
+    DCHECK(hash == Hasher<T>::hashed(item)) << "Hash does not match the item.";
+
+    auto bucket = this->find_bucket_for_writing(hash, [&](T& t) {
       return item == t;
     });
     DCHECK(bucket) << "Could not find a bucket for writing.";
 
-    bool is_new = !bucket->is_used();
+    bool is_new = !bucket.is_used();
 
-    bucket->set(std::forward<T>(item));
+    bucket.set(std::move(item));
 
     if (is_new) {
       ++this->size_;
     }
 
-    return {is_new, bucket->pointer()};
+    return {is_new, bucket.pointer()};
   }
 
   // Returns true if the item was found and removed from the table.
   bool remove(const T& item) {
-    auto hash = Hash<T>::hashed(item);
-    auto* bucket = this->find_bucket_for_reading(hash, [&](T& t) {
-      return item == t;
+    return remove_with_hash(Hasher<T>::hashed(item), item);
+  }
+
+  template <typename LookupType, typename = EnableIfHashCompatible<T, LookupType>>
+  bool remove(const LookupType& item) {
+    return remove_with_hash(Hasher<LookupType>::hashed(item), item);
+  }
+
+  // Same as `remove`, but with the hash of `item` already calculated.
+  template <typename LookupType>
+  bool remove_with_hash(HashedValue hash, const LookupType& item) {
+    static_assert(std::is_same_v<T, LookupType> || IsHashCompatible<T, LookupType>::value,
+                  "Lookup type is not hash compatible with the item type.");
+    DCHECK(hash == Hasher<LookupType>::hashed(item)) << "Hash does not match the item.";
+
+    auto bucket = this->find_bucket_for_reading(hash, [&](T& t) {
+      return t == item;
     });
     if (!bucket) {
       return false;
     }
 
-    bucket->clear();
-
-    --this->size_;
+    this->erase_bucket(bucket);
 
     return true;
   }
+
+private:
+  void insert_all(const T* begin, const T* end, MemSize count) {
+    this->reserve(count);
+    for (auto* item = begin; item != end; ++item) {
+      auto bucket = this->find_bucket_for_writing_reserved(Hasher<T>::hashed(*item), [&](T& t) {
+        return *item == t;
+      });
+
+      if (!bucket.is_used()) {
+        ++this->size_;
+      }
+      bucket.set(*item);
+    }
+  }
 };
 
-template <typename T>
-inline std::ostream& operator<<(std::ostream& os, const HashTable<T>& hash_table) {
+template <typename T, typename ProbingPolicy, template <typename> class Hasher, typename Allocator>
+inline std::ostream& operator<<(std::ostream& os,
+                                const HashTable<T, ProbingPolicy, Hasher, Allocator>& hash_table) {
   os << '[';
   MemSize i = 1;
   for (const auto& item : hash_table) {
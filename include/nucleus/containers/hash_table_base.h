@@ -1,17 +1,28 @@
 #pragma once
 
+#include <algorithm>
+#include <cstdlib>
 #include <cstring>
-
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include "nucleus/bits.h"
+#include "nucleus/containers/array_view.h"
+#include "nucleus/containers/hash_table_probing.h"
+#include "nucleus/containers/hash_table_statistics.h"
 #include "nucleus/hash.h"
 #include "nucleus/logging.h"
 #include "nucleus/macros.h"
+#include "nucleus/memory/allocator.h"
 
 namespace nu {
 
-template <typename ItemType>
+// `Hasher` is the family of hash functions to use, `Hash` or `SeededHash`.
+template <typename ItemType, template <typename> class Hasher = Hash>
 struct DefaultHashTableBaseTraits {
   static HashedValue hashed(const ItemType& item) {
-    return Hash<ItemType>::hashed(item);
+    return Hasher<ItemType>::hashed(item);
   }
 
   static bool equals(const ItemType& left, const ItemType& right) {
@@ -19,23 +30,34 @@ struct DefaultHashTableBaseTraits {
   }
 };
 
-template <typename ItemType, typename Traits = DefaultHashTableBaseTraits<ItemType>>
+// Open addressing hash table that keeps a control byte per slot in an array separate from the
+// items.  Where items go and what the control bytes mean is decided by the `ProbingPolicy`, see
+// `GroupProbing` and `RobinHoodProbing`.  The control bytes and the items share a single allocation
+// from `Allocator`, see `MallocAllocator`.
+template <typename ItemType, typename Traits = DefaultHashTableBaseTraits<ItemType>,
+          typename ProbingPolicy = GroupProbing,
+          typename Allocator = MallocAllocator<AllocationTag::HashTable>>
 class HashTableBase {
+  using ControlByte = detail::ControlByte;
+
 public:
   class Iterator {
   public:
     NU_DEFAULT_COPY(Iterator);
 
     ItemType& operator*() const {
-      return hash_table_->buckets_[index_].reference();
+      return hash_table_->slots_[index_];
     }
 
     ItemType* operator->() {
-      return hash_table_->buckets_[index_].pointer();
+      return &hash_table_->slots_[index_];
     }
 
     Iterator& operator++() {
       index_ = hash_table_->index_of_first_used_bucket_from(index_ + 1);
+      if (index_ >= end_) {
+        index_ = hash_table_->capacity_;
+      }
 
       return *this;
     }
@@ -55,21 +77,46 @@ public:
     }
 
   private:
-    friend class HashTableBase<ItemType, Traits>;
+    friend class HashTableBase;
+
+    Iterator(const HashTableBase* hash_table, MemSize index)
+      : hash_table_{hash_table}, index_{index}, end_{hash_table->capacity_} {}
 
-    Iterator(const HashTableBase<ItemType, Traits>* hash_table, MemSize index)
-      : hash_table_{hash_table}, index_{index} {}
+    Iterator(const HashTableBase* hash_table, MemSize index, MemSize end)
+      : hash_table_{hash_table}, index_{index < end ? index : hash_table->capacity_}, end_{end} {}
 
-    const HashTableBase<ItemType, Traits>* hash_table_;
+    const HashTableBase* hash_table_;
     MemSize index_;
+    // Iteration stops before this slot.  The slots from here on hold items that were visited before
+    // `erase` shifted them back around the end of the table.
+    MemSize end_;
   };
 
   HashTableBase() = default;
 
+  explicit HashTableBase(const Allocator& allocator) : allocator_{allocator} {}
+
+  // Copies are made at the same capacity, with every item in the same slot as in `other`, so
+  // nothing has to be hashed again.
+  HashTableBase(const HashTableBase& other)
+    : max_load_factor_{other.max_load_factor_}, allocator_{other.allocator_} {
+    copy_from(other);
+  }
+
   ~HashTableBase() {
     clear();
   }
 
+  HashTableBase& operator=(const HashTableBase& other) {
+    if (this != &other) {
+      clear();
+      max_load_factor_ = other.max_load_factor_;
+      copy_from(other);
+    }
+
+    return *this;
+  }
+
   NU_NO_DISCARD MemSize size() const {
     return size_;
   }
@@ -82,6 +129,10 @@ public:
     return capacity_;
   }
 
+  const Allocator& allocator() const {
+    return allocator_;
+  }
+
   Iterator begin() const {
     return Iterator{this, index_of_first_used_bucket_from(0)};
   }
@@ -99,179 +150,448 @@ public:
   }
 
   void clear() {
-    for (MemSize i = 0; i < size_; ++i) {
-      auto& ref = buckets_[i].reference();
-      ref.~ItemType();
+    if constexpr (!std::is_trivially_destructible_v<ItemType>) {
+      for (auto& item : *this) {
+        item.~ItemType();
+      }
+    }
+    if (control_) {
+      allocator_.deallocate(control_, allocation_size(capacity_));
     }
-    std::free(buckets_);
+    control_ = nullptr;
+    slots_ = nullptr;
     size_ = 0;
+    deleted_ = 0;
     capacity_ = 0;
+    growth_limit_ = 0;
+  }
+
+  // Removes the item `it` points to and returns an iterator to the next item, so items can be
+  // removed while iterating over the table.  Every item is still visited exactly once.
+  Iterator erase(Iterator it) {
+    DCHECK(it.hash_table_ == this && it.index_ < capacity_) << "Invalid iterator.";
+
+    MemSize mask = capacity_ - 1;
+    MemSize freed = erase_at(it.index_);
+
+    // Items after the removed one might have been shifted back by one slot.  If that moved the item
+    // at `end_`, or the item in the first slot to the last one, an item that was already visited
+    // now sits just before `end_`.
+    MemSize end = it.end_;
+    MemSize end_distance = (end - it.index_) & mask;
+    if (end_distance != 0 && end_distance <= ((freed - it.index_) & mask)) {
+      --end;
+    }
+
+    // The slot might have been filled by an item shifted back by the probing policy.
+    return Iterator{this, index_of_first_used_bucket_from(it.index_), end};
+  }
+
+  // Make sure `size` items fit without the table growing again, taking the maximum load factor into
+  // account.
+  void reserve(MemSize size) {
+    ensure_capacity(size);
+  }
+
+  // The fraction of slots, including tombstones left behind by removed items, that may be in use
+  // before the table grows.
+  NU_NO_DISCARD F32 max_load_factor() const {
+    return max_load_factor_;
+  }
+
+  void set_max_load_factor(F32 max_load_factor) {
+    DCHECK(max_load_factor > 0.0f && max_load_factor <= 1.0f) << "Invalid max load factor.";
+
+    max_load_factor_ = max_load_factor;
+    growth_limit_ = growth_limit_for(capacity_);
+  }
+
+  // Walks every slot of the table and follows the probe of every item, up to
+  // `HashTableStatistics::MAX_PROBE_LENGTH` steps each.  That is cheap for a healthy table, but can
+  // cost that many times more than iterating over a badly clustered one.  Nothing is counted while
+  // the table is being used, so tables that are never inspected pay nothing.
+  NU_NO_DISCARD HashTableStatistics statistics() const {
+    HashTableStatistics result;
+    result.size = size_;
+    result.capacity = capacity_;
+    result.tombstones = deleted_;
+    if (capacity_ == 0) {
+      return result;
+    }
+
+    result.load_factor = static_cast<F32>(size_) / static_cast<F32>(capacity_);
+
+    auto histogram_index = [](MemSize probe_length) {
+      return std::min(probe_length, HashTableStatistics::PROBE_LENGTH_BUCKETS) - 1;
+    };
+
+    MemSize cluster_size = 0;
+    auto end_cluster = [&result, &cluster_size]() {
+      if (cluster_size > 0) {
+        ++result.cluster_sizes[63 - count_leading_zeros(static_cast<U64>(cluster_size))];
+        result.max_cluster_size = std::max(result.max_cluster_size, cluster_size);
+        cluster_size = 0;
+      }
+    };
+
+    MemSize total_hit_probe_length = 0;
+    for (MemSize i = 0; i < capacity_; ++i) {
+      if (ProbingPolicy::is_full(control_[i])) {
+        MemSize probe_length =
+            ProbingPolicy::probe_length(control_, capacity_, Traits::hashed(slots_[i]), i,
+                                        HashTableStatistics::MAX_PROBE_LENGTH);
+        total_hit_probe_length += probe_length;
+        result.max_hit_probe_length = std::max(result.max_hit_probe_length, probe_length);
+        ++result.hit_probe_lengths[histogram_index(probe_length)];
+        ++cluster_size;
+      } else if (ProbingPolicy::is_tombstone(control_[i])) {
+        ++cluster_size;
+      } else {
+        end_cluster();
+      }
+    }
+    end_cluster();
+
+    MemSize total_miss_probe_length = 0;
+    MemSize miss_count = 0;
+    // The capacity and the stride are powers of two, so the sample stride is too.
+    MemSize miss_stride = std::max(ProbingPolicy::PROBE_START_STRIDE,
+                                   capacity_ / HashTableStatistics::MAX_MISS_SAMPLES);
+    for (MemSize i = 0; i < capacity_; i += miss_stride) {
+      MemSize probe_length = ProbingPolicy::miss_probe_length(
+          control_, capacity_, i, HashTableStatistics::MAX_PROBE_LENGTH);
+      total_miss_probe_length += probe_length;
+      ++miss_count;
+      result.max_miss_probe_length = std::max(result.max_miss_probe_length, probe_length);
+      ++result.miss_probe_lengths[histogram_index(probe_length)];
+    }
+
+    if (size_ > 0) {
+      result.average_hit_probe_length =
+          static_cast<F64>(total_hit_probe_length) / static_cast<F64>(size_);
+    }
+    result.average_miss_probe_length =
+        static_cast<F64>(total_miss_probe_length) / static_cast<F64>(miss_count);
+
+    return result;
   }
 
 protected:
+  // A handle to a single slot in the table: its control byte and its item storage.  A default
+  // constructed bucket refers to nothing and converts to `false`.
   class Bucket {
   public:
-    Bucket() {}
-    ~Bucket() {}
+    Bucket() = default;
 
-    bool is_used() const {
-      return used_ == 1;
+    explicit operator bool() const {
+      return control_ != nullptr;
     }
 
-    bool is_deleted() const {
-      return deleted_;
-    }
-
-    void set(const ItemType& item) {
-      new (data_.raw) ItemType{item};
-      used_ = 1;
-      deleted_ = 0;
+    bool is_used() const {
+      return ProbingPolicy::is_full(*control_);
     }
 
-    void set(ItemType&& item) {
-      new (data_.raw) ItemType{std::forward<ItemType>(item)};
-      used_ = 1;
-      deleted_ = 0;
+    template <typename... Args>
+    void set(Args&&... args) {
+      if (is_used()) {
+        slot_->~ItemType();
+      }
+      new (slot_) ItemType{std::forward<Args>(args)...};
+      *control_ = new_control_;
     }
 
-    void clear() {
-      reference().~ItemType();
-      used_ = 0;
-      deleted_ = 1;
+    // Fills an unused bucket by calling `construct(void* memory)`, which must construct the item
+    // in `memory`.  Lets callers build the members of an item in place, without a temporary.
+    template <typename Constructor>
+    void construct_with(Constructor&& construct) {
+      DCHECK(!is_used());
+      construct(static_cast<void*>(slot_));
+      *control_ = new_control_;
     }
 
-    ItemType* pointer() {
-      return reinterpret_cast<ItemType*>(&data_);
+    ItemType* pointer() const {
+      return slot_;
     }
 
-    ItemType& reference() {
-      return reinterpret_cast<ItemType&>(*reinterpret_cast<ItemType*>(&data_));
+    ItemType& reference() const {
+      return *slot_;
     }
 
   private:
-    union {
-      ItemType typed;
-      U8 raw[sizeof(ItemType)];
-    } data_;
-    U8 used_;
-    U8 deleted_;
+    friend class HashTableBase;
+
+    Bucket(ControlByte* control, ItemType* slot, ControlByte new_control)
+      : control_{control}, slot_{slot}, new_control_{new_control} {}
+
+    ControlByte* control_ = nullptr;
+    ItemType* slot_ = nullptr;
+    // The control byte to store when an item is set.
+    ControlByte new_control_ = 0;
   };
 
-  NU_NO_DISCARD MemSize index_of_first_used_bucket_from(MemSize start) const {
-    for (;;) {
-      if (start == capacity_) {
-        break;
-      }
+  // The capacity is always a power of two multiple of the group width, so groups never wrap around
+  // the end of the control bytes.
+  static constexpr MemSize MIN_SIZE = detail::Group::WIDTH;
+
+  static constexpr F32 DEFAULT_MAX_LOAD_FACTOR = 0.875f;
 
-      if (buckets_[start].is_used()) {
-        break;
+  // Finds the next item by scanning the control bytes, 64 slots at a time, without touching the
+  // slots themselves.
+  NU_NO_DISCARD MemSize index_of_first_used_bucket_from(MemSize start) const {
+    while (start < capacity_) {
+      MemSize word_start = start & ~static_cast<MemSize>(63);
+      U64 full = full_slots_from(word_start) >> (start - word_start);
+      if (full) {
+        return start + count_trailing_zeros(full);
       }
 
-      ++start;
+      start = word_start + 64;
     }
 
-    return start;
+    return capacity_;
   }
 
-  // static_assert(std::is_trivially_constructible_v<Bucket>);
-
-  static constexpr MemSize MIN_SIZE = 4;
-
   template <typename Predicate>
-  Bucket* find_bucket_for_reading(HashedValue hash, Predicate predicate) const {
+  Bucket find_bucket_for_reading(HashedValue hash, Predicate predicate) const {
     if (capacity_ == 0) {
-      return nullptr;
+      return {};
     }
 
-    MemSize index = hash % capacity_;
-    MemSize start_index = index;
+    MemSize index = ProbingPolicy::find(control_, slots_, capacity_, hash, predicate);
+    if (index == capacity_) {
+      return {};
+    }
 
-    for (;;) {
-      Bucket* bucket = &buckets_[index];
+    return Bucket{&control_[index], &slots_[index], control_[index]};
+  }
 
-      if (!bucket->is_used() && !bucket->is_deleted()) {
-        return nullptr;
+  // Number of lookups `find_buckets_for_reading` prefetches ahead of resolving them.
+  static constexpr MemSize LOOKUP_BATCH_SIZE = 16;
+
+  // Look up many keys.  Each batch of keys is hashed and the memory where their probes start is
+  // prefetched before any of them are resolved, so the cache misses of a whole batch overlap
+  // instead of happening one after the other.  `callback` is called with the index of each key and
+  // its bucket, in order.
+  template <typename LookupType, typename Hasher, typename Matcher, typename Callback>
+  void find_buckets_for_reading(ArrayView<LookupType> keys, Hasher&& hasher, Matcher&& matcher,
+                                Callback&& callback) const {
+    HashedValue hashes[LOOKUP_BATCH_SIZE];
+
+    for (MemSize batch_start = 0; batch_start < keys.size(); batch_start += LOOKUP_BATCH_SIZE) {
+      const LookupType* batch = keys.data() + batch_start;
+      MemSize batch_size = std::min(LOOKUP_BATCH_SIZE, keys.size() - batch_start);
+
+      for (MemSize i = 0; i < batch_size; ++i) {
+        hashes[i] = hasher(batch[i]);
+        prefetch_for_reading(hashes[i]);
       }
 
-      if (!bucket->is_deleted() && predicate(bucket->reference())) {
-        return bucket;
+      for (MemSize i = 0; i < batch_size; ++i) {
+        callback(batch_start + i, find_bucket_for_reading(hashes[i], [&](ItemType& item) {
+                   return matcher(item, batch[i]);
+                 }));
       }
+    }
+  }
 
-      ++index;
-      index %= capacity_;
+  // Returns the bucket holding an item matching `predicate` or, if there is none, a free bucket
+  // where the item should be stored.  The table might grow to make space for the new item.  A free
+  // bucket is counted as taken, so the caller must store an item in it.
+  template <typename Predicate>
+  Bucket find_bucket_for_writing(HashedValue hash, Predicate predicate) {
+    Bucket existing = find_bucket_for_reading(hash, predicate);
+    if (existing) {
+      return existing;
+    }
 
-      if (index == start_index) {
-        break;
-      }
+    if (size_ + deleted_ + 1 > growth_limit_) {
+      make_space_for_insert();
     }
 
-    return nullptr;
+    return take_free_bucket(hash);
   }
 
-  void ensure_capacity(MemSize required_capacity) {
-    if (required_capacity <= capacity_) {
+  // Same as `find_bucket_for_writing`, for bulk inserts that reserved space for all their items
+  // up front, so there is no need to check whether the table has to grow.
+  template <typename Predicate>
+  Bucket find_bucket_for_writing_reserved(HashedValue hash, Predicate predicate) {
+    Bucket existing = find_bucket_for_reading(hash, predicate);
+    if (existing) {
+      return existing;
+    }
+
+    DCHECK(size_ + deleted_ + 1 <= growth_limit_) << "No space was reserved for the item.";
+
+    return take_free_bucket(hash);
+  }
+
+  // Destroys the item in a used bucket and frees the slot.
+  void erase_bucket(const Bucket& bucket) {
+    DCHECK(bucket && bucket.is_used());
+
+    erase_at(static_cast<MemSize>(bucket.control_ - control_));
+  }
+
+  // Make sure that `required_size` items fit without going over the maximum load factor.
+  void ensure_capacity(MemSize required_size) {
+    if (required_size + deleted_ <= growth_limit_) {
       return;
     }
 
-    MemSize new_capacity = std::max(capacity_ * 2, MIN_SIZE);
-    DCHECK(required_capacity <= new_capacity);
+    resize(capacity_for(required_size));
+  }
 
-    Bucket* old_buckets = buckets_;
-    MemSize old_capacity = capacity_;
+  MemSize size_ = 0;
+  // Number of tombstones left behind by removed items.
+  MemSize deleted_ = 0;
+  MemSize capacity_ = 0;
+  // Number of items plus tombstones the table can hold before it has to grow.
+  MemSize growth_limit_ = 0;
+  F32 max_load_factor_ = DEFAULT_MAX_LOAD_FACTOR;
+  ControlByte* control_ = nullptr;
+  ItemType* slots_ = nullptr;
+  NU_NO_UNIQUE_ADDRESS Allocator allocator_;
+
+private:
+  // Bit `i` is set if slot `word_start + i` holds an item.  `word_start` must be a multiple of 64.
+  NU_NO_DISCARD U64 full_slots_from(MemSize word_start) const {
+    constexpr MemSize WIDTH = detail::Group::WIDTH;
+
+    U64 full = 0;
+    MemSize end = std::min(word_start + 64, capacity_);
+    for (MemSize group = word_start; group < end; group += WIDTH) {
+      full |= static_cast<U64>(ProbingPolicy::match_full(control_ + group)) << (group - word_start);
+    }
+    return full;
+  }
 
-    buckets_ = static_cast<Bucket*>(std::malloc(sizeof(Bucket) * new_capacity));
-    std::memset(buckets_, 0, sizeof(Bucket) * new_capacity);
-    capacity_ = new_capacity;
+  // Returns the slot that ended up empty, see `detail::EraseResult`.
+  MemSize erase_at(MemSize index) {
+    DCHECK(ProbingPolicy::is_full(control_[index]));
 
-    if (old_buckets) {
-      for (MemSize i = 0; i < old_capacity; ++i) {
-        if (old_buckets[i].is_used()) {
-          auto old_hash = Traits::hashed(old_buckets[i].reference());
-          Bucket* new_bucket = find_bucket_for_writing(old_hash, [&](ItemType& t) {
-            return Traits::equals(t, old_buckets[i].reference());
-          });
-          new_bucket->set(std::move(old_buckets[i].reference()));
+    auto result = ProbingPolicy::erase(control_, slots_, capacity_, index, &Traits::hashed);
+    if (result.left_tombstone) {
+      ++deleted_;
+    }
+    --size_;
 
-          old_buckets[i].pointer()->~ItemType();
-        }
-      }
+    return result.freed;
+  }
 
-      std::free(old_buckets);
+  void prefetch_for_reading(HashedValue hash) const {
+    if (capacity_ == 0) {
+      return;
     }
+
+    MemSize index = ProbingPolicy::probe_start(capacity_, hash);
+    NU_PREFETCH(&control_[index]);
+    NU_PREFETCH(&slots_[index]);
   }
 
-  template <typename Predicate>
-  Bucket* find_bucket_for_writing(HashedValue hash, Predicate predicate) {
-    ensure_capacity(size_ + 1);
+  NU_NO_DISCARD MemSize growth_limit_for(MemSize capacity) const {
+    return static_cast<MemSize>(static_cast<F64>(capacity) * max_load_factor_);
+  }
+
+  // The smallest capacity larger than the current one that holds `size` items.
+  NU_NO_DISCARD MemSize capacity_for(MemSize size) const {
+    MemSize capacity = std::max(capacity_ * 2, MIN_SIZE);
+    while (growth_limit_for(capacity) < size) {
+      capacity *= 2;
+    }
+    return capacity;
+  }
 
-    MemSize index = hash % capacity_;
-    MemSize start_index = index;
+  // There must be space for one more item.
+  Bucket take_free_bucket(HashedValue hash) {
+    auto slot = ProbingPolicy::prepare_insert(control_, slots_, capacity_, hash);
+    if (ProbingPolicy::is_tombstone(control_[slot.index])) {
+      --deleted_;
+    }
 
-    for (;;) {
-      Bucket* bucket = &buckets_[index];
+    return Bucket{&control_[slot.index], &slots_[slot.index], slot.control};
+  }
 
-      if (bucket->is_used() && predicate(bucket->reference())) {
-        return bucket;
-      }
+  // Called when inserting one more item would go over the growth limit.  If most of the used slots
+  // are tombstones, they are cleared out without allocating.  Otherwise the table grows.
+  void make_space_for_insert() {
+    if (deleted_ > 0 && size_ + 1 <= growth_limit_ / 2) {
+      ProbingPolicy::rehash_in_place(control_, slots_, capacity_, &Traits::hashed);
+      deleted_ = 0;
+    } else {
+      resize(capacity_for(size_ + 1));
+    }
+  }
 
-      if (!bucket->is_used()) {
-        return bucket;
+  void copy_from(const HashTableBase& other) {
+    if (other.capacity_ == 0) {
+      return;
+    }
+
+    allocate(other.capacity_);
+    std::memcpy(control_, other.control_, capacity_);
+
+    if constexpr (std::is_trivially_copyable_v<ItemType>) {
+      std::memcpy(static_cast<void*>(slots_), other.slots_, sizeof(ItemType) * capacity_);
+    } else {
+      for (MemSize i = 0; i < capacity_; ++i) {
+        if (ProbingPolicy::is_full(control_[i])) {
+          new (&slots_[i]) ItemType{other.slots_[i]};
+        }
       }
+    }
 
-      ++index;
-      index %= capacity_;
+    size_ = other.size_;
+    deleted_ = other.deleted_;
+  }
 
-      if (index == start_index) {
-        break;
+  void resize(MemSize new_capacity) {
+    ControlByte* old_control = control_;
+    ItemType* old_slots = slots_;
+    MemSize old_capacity = capacity_;
+
+    allocate(new_capacity);
+
+    for (MemSize i = 0; i < old_capacity; ++i) {
+      if (ProbingPolicy::is_full(old_control[i])) {
+        auto slot = ProbingPolicy::prepare_insert(control_, slots_, capacity_,
+                                                  Traits::hashed(old_slots[i]));
+        new (&slots_[slot.index]) ItemType{std::move(old_slots[i])};
+        control_[slot.index] = slot.control;
+
+        old_slots[i].~ItemType();
       }
     }
 
-    return nullptr;
+    if (old_control) {
+      allocator_.deallocate(old_control, allocation_size(old_capacity));
+    }
   }
 
-  MemSize size_ = 0;
-  MemSize capacity_ = 0;
-  Bucket* buckets_ = nullptr;
+  // The control bytes and the slots share a single allocation, with the slots following the
+  // control bytes.
+  static MemSize slots_offset(MemSize capacity) {
+    return (capacity + alignof(ItemType) - 1) / alignof(ItemType) * alignof(ItemType);
+  }
+
+  static MemSize allocation_size(MemSize capacity) {
+    return slots_offset(capacity) + sizeof(ItemType) * capacity;
+  }
+
+  void allocate(MemSize capacity) {
+    DCHECK(is_power_of_two(capacity) && capacity >= MIN_SIZE);
+
+    MemSize offset = slots_offset(capacity);
+    auto* memory =
+        static_cast<U8*>(allocator_.allocate(allocation_size(capacity), alignof(ItemType)));
+    DCHECK(memory) << "Out of memory.";
+
+    control_ = memory;
+    std::memset(control_, ProbingPolicy::EMPTY, capacity);
+    slots_ = reinterpret_cast<ItemType*>(memory + offset);
+    capacity_ = capacity;
+    deleted_ = 0;
+    growth_limit_ = growth_limit_for(capacity);
+  }
 };
 
 }  // namespace nu
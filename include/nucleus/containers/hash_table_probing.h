@@ -0,0 +1,565 @@
+#pragma once
+
+#include <algorithm>
+#include <cstring>
+#include <new>
+#include <utility>
+
+#include "nucleus/bits.h"
+#include "nucleus/config.h"
+#include "nucleus/hash.h"
+#include "nucleus/logging.h"
+#include "nucleus/macros.h"
+
+#if ARCH(CPU_SSE2)
+#include <emmintrin.h>
+#endif
+
+namespace nu {
+
+namespace detail {
+
+// Every slot in a hash table has a control byte that is stored apart from the items.  What the
+// byte means is up to the probing policy.
+using ControlByte = U8;
+
+// Control bytes used by `GroupProbing`.  A full slot stores the low 7 bits of the item's hash, so
+// most mismatches are rejected without touching the item at all.  Empty and deleted slots have the
+// high bit set.
+constexpr ControlByte CONTROL_EMPTY = 0x80;
+constexpr ControlByte CONTROL_DELETED = 0xFE;
+
+constexpr bool is_full(ControlByte control) {
+  return (control & 0x80) == 0;
+}
+
+// Spreads a hash over the whole range of slots.  Fibonacci hashing makes sure that weak hashes,
+// where only the low bits vary, still end up all over the table.  The high half of a 64-bit hash is
+// folded in first, because the bits that are used only depend on the low half of the product.
+constexpr MemSize fibonacci_index(U64 hash) {
+  return static_cast<MemSize>(((hash ^ (hash >> 32)) * 0x9E3779B97F4A7C15ull) >> 32);
+}
+
+// A set of slots inside a group, one bit per slot.  Iterating it yields the slot offsets from the
+// lowest to the highest.
+class GroupMask {
+public:
+  explicit GroupMask(U32 mask) : mask_{mask} {}
+
+  explicit operator bool() const {
+    return mask_ != 0;
+  }
+
+  NU_NO_DISCARD U32 lowest() const {
+    return count_trailing_zeros(mask_);
+  }
+
+  NU_NO_DISCARD U32 bits() const {
+    return mask_;
+  }
+
+  GroupMask begin() const {
+    return *this;
+  }
+
+  GroupMask end() const {
+    return GroupMask{0};
+  }
+
+  U32 operator*() const {
+    return lowest();
+  }
+
+  GroupMask& operator++() {
+    mask_ &= mask_ - 1;
+    return *this;
+  }
+
+  friend bool operator!=(const GroupMask& left, const GroupMask& right) {
+    return left.mask_ != right.mask_;
+  }
+
+private:
+  U32 mask_;
+};
+
+// A run of control bytes that is probed in one go.  With SSE2 all 16 bytes are compared with a
+// single instruction.
+class Group {
+public:
+  static constexpr MemSize WIDTH = 16;
+
+  explicit Group(const ControlByte* control) {
+#if ARCH(CPU_SSE2)
+    control_ = _mm_loadu_si128(reinterpret_cast<const __m128i*>(control));
+#else
+    std::memcpy(control_, control, WIDTH);
+#endif
+  }
+
+  // Slots holding an item with the given 7-bit hash fragment.
+  NU_NO_DISCARD GroupMask match(ControlByte h2) const {
+#if ARCH(CPU_SSE2)
+    auto fragment = _mm_set1_epi8(static_cast<char>(h2));
+    return GroupMask{static_cast<U32>(_mm_movemask_epi8(_mm_cmpeq_epi8(fragment, control_)))};
+#else
+    return match_predicate([h2](ControlByte control) {
+      return control == h2;
+    });
+#endif
+  }
+
+  NU_NO_DISCARD GroupMask match_empty() const {
+#if ARCH(CPU_SSE2)
+    auto empty = _mm_set1_epi8(static_cast<char>(CONTROL_EMPTY));
+    return GroupMask{static_cast<U32>(_mm_movemask_epi8(_mm_cmpeq_epi8(empty, control_)))};
+#else
+    return match_predicate([](ControlByte control) {
+      return control == CONTROL_EMPTY;
+    });
+#endif
+  }
+
+  NU_NO_DISCARD GroupMask match_empty_or_deleted() const {
+#if ARCH(CPU_SSE2)
+    // Only empty and deleted slots have the high bit set.
+    return GroupMask{static_cast<U32>(_mm_movemask_epi8(control_))};
+#else
+    return match_predicate([](ControlByte control) {
+      return !is_full(control);
+    });
+#endif
+  }
+
+  NU_NO_DISCARD GroupMask match_full() const {
+#if ARCH(CPU_SSE2)
+    return GroupMask{~static_cast<U32>(_mm_movemask_epi8(control_)) & 0xFFFF};
+#else
+    return match_predicate([](ControlByte control) {
+      return is_full(control);
+    });
+#endif
+  }
+
+private:
+#if ARCH(CPU_SSE2)
+  __m128i control_;
+#else
+  template <typename Predicate>
+  GroupMask match_predicate(Predicate predicate) const {
+    U32 mask = 0;
+    for (MemSize i = 0; i < WIDTH; ++i) {
+      if (predicate(control_[i])) {
+        mask |= 1u << i;
+      }
+    }
+    return GroupMask{mask};
+  }
+
+  ControlByte control_[WIDTH];
+#endif
+};
+
+// A free slot returned by a probing policy, along with the control byte to store in it once it
+// holds an item.
+struct InsertSlot {
+  MemSize index;
+  ControlByte control;
+};
+
+// What a probing policy did to remove an item.
+struct EraseResult {
+  // True if the slot became a tombstone instead of an empty slot.
+  bool left_tombstone;
+  // The slot that ended up empty.  Policies that shift the items after the removed one back to fill
+  // its slot return the slot of the last item they moved, otherwise the slot of the removed item.
+  MemSize freed;
+};
+
+}  // namespace detail
+
+// A probing policy decides where items are stored in a `HashTableBase` and what the control byte of
+// each slot means.  All functions work on the raw control bytes and slots of a table with a power
+// of two capacity of at least `Group::WIDTH`.  `find` returns `capacity` when nothing matches.
+
+// Swiss table style probing.  Control bytes hold a 7-bit hash fragment and are probed a
+// `detail::Group` at a time, so items are only compared when their fragment matches.  Removed items
+// leave tombstones behind.
+struct GroupProbing {
+  using ControlByte = detail::ControlByte;
+  using Group = detail::Group;
+
+  static constexpr ControlByte EMPTY = detail::CONTROL_EMPTY;
+
+  static bool is_full(ControlByte control) {
+    return detail::is_full(control);
+  }
+
+  static bool is_tombstone(ControlByte control) {
+    return control == detail::CONTROL_DELETED;
+  }
+
+  // One bit for each of the `Group::WIDTH` slots from `control` that holds an item.
+  static U32 match_full(const ControlByte* control) {
+    return Group{control}.match_full().bits();
+  }
+
+  // Probe lengths count groups, and every slot in a group is the start of the same probe sequence.
+  static constexpr MemSize PROBE_START_STRIDE = Group::WIDTH;
+
+  // Number of groups a lookup for `hash` probes to find the item at `index`, but no more than
+  // `limit`.
+  static MemSize probe_length(const ControlByte*, MemSize capacity, HashedValue hash,
+                              MemSize index, MemSize limit) {
+    MemSize group_count = capacity / Group::WIDTH;
+    MemSize target = index / Group::WIDTH * Group::WIDTH;
+
+    ProbeSequence sequence{hash, group_count};
+    while (sequence.offset() != target && sequence.probes() + 1 < limit) {
+      DCHECK(sequence.probes() < group_count) << "Item is not on its probe sequence.";
+      sequence.next();
+    }
+
+    return sequence.probes() + 1;
+  }
+
+  // Number of groups a lookup that does not find anything probes if it starts at `start`, but no
+  // more than `limit`.
+  static MemSize miss_probe_length(const ControlByte* control, MemSize capacity, MemSize start,
+                                   MemSize limit) {
+    MemSize group_count = capacity / Group::WIDTH;
+    limit = std::min(limit, group_count);
+
+    auto sequence = ProbeSequence::starting_at(start / Group::WIDTH, group_count);
+    while (sequence.probes() + 1 < limit) {
+      if (Group{control + sequence.offset()}.match_empty()) {
+        break;
+      }
+      sequence.next();
+    }
+
+    return sequence.probes() + 1;
+  }
+
+  // The first slot a lookup for `hash` looks at.
+  static MemSize probe_start(MemSize capacity, HashedValue hash) {
+    return ProbeSequence{hash, capacity / Group::WIDTH}.offset();
+  }
+
+  template <typename ItemType, typename Predicate>
+  static MemSize find(const ControlByte* control, ItemType* slots, MemSize capacity,
+                      HashedValue hash, Predicate&& predicate) {
+    ControlByte h2 = hash_h2(hash);
+    MemSize group_count = capacity / Group::WIDTH;
+
+    for (ProbeSequence sequence{hash, group_count}; sequence.probes() < group_count;
+         sequence.next()) {
+      MemSize offset = sequence.offset();
+      Group group{control + offset};
+
+      for (U32 i : group.match(h2)) {
+        if (predicate(slots[offset + i])) {
+          return offset + i;
+        }
+      }
+
+      // An empty slot would have ended the probe sequence of any item inserted after it.
+      if (group.match_empty()) {
+        break;
+      }
+    }
+
+    return capacity;
+  }
+
+  // Returns the first empty or deleted slot on the probe sequence of `hash`.  There must be at
+  // least one such slot.
+  template <typename ItemType>
+  static detail::InsertSlot prepare_insert(ControlByte* control, ItemType*, MemSize capacity,
+                                           HashedValue hash) {
+    MemSize group_count = capacity / Group::WIDTH;
+
+    for (ProbeSequence sequence{hash, group_count};; sequence.next()) {
+      DCHECK(sequence.probes() < group_count) << "No free slot in the table.";
+      auto free_slots = Group{control + sequence.offset()}.match_empty_or_deleted();
+      if (free_slots) {
+        return {sequence.offset() + free_slots.lowest(), hash_h2(hash)};
+      }
+    }
+  }
+
+  // Destroys the item at `index` and frees its slot, which might become a tombstone.
+  template <typename ItemType, typename Hasher>
+  static detail::EraseResult erase(ControlByte* control, ItemType* slots, MemSize, MemSize index,
+                                   Hasher&&) {
+    slots[index].~ItemType();
+
+    // A group that still has an empty slot was never full, so no probe sequence ever continued
+    // past it and the slot can simply become empty again.
+    if (Group{control + index / Group::WIDTH * Group::WIDTH}.match_empty()) {
+      control[index] = detail::CONTROL_EMPTY;
+      return {false, index};
+    }
+
+    control[index] = detail::CONTROL_DELETED;
+    return {true, index};
+  }
+
+  // Moves every item to the first free slot on its probe sequence without allocating, which removes
+  // all the tombstones.
+  template <typename ItemType, typename Hasher>
+  static void rehash_in_place(ControlByte* control, ItemType* slots, MemSize capacity,
+                              Hasher&& hasher) {
+    // Mark tombstones as empty and items as deleted, which here means "still has to be placed".
+    for (MemSize i = 0; i < capacity; ++i) {
+      control[i] = is_full(control[i]) ? detail::CONTROL_DELETED : detail::CONTROL_EMPTY;
+    }
+
+    alignas(ItemType) U8 temp[sizeof(ItemType)];
+
+    for (MemSize i = 0; i < capacity; ++i) {
+      if (control[i] != detail::CONTROL_DELETED) {
+        continue;
+      }
+
+      HashedValue hash = hasher(slots[i]);
+      MemSize index = prepare_insert(control, slots, capacity, hash).index;
+
+      // Already in the first group with space, so the item can stay where it is.
+      if (index / Group::WIDTH == i / Group::WIDTH) {
+        control[i] = hash_h2(hash);
+        continue;
+      }
+
+      if (control[index] == detail::CONTROL_EMPTY) {
+        new (&slots[index]) ItemType{std::move(slots[i])};
+        slots[i].~ItemType();
+        control[index] = hash_h2(hash);
+        control[i] = detail::CONTROL_EMPTY;
+      } else {
+        // The target holds another item that still has to be placed.  Swap them and place the item
+        // that ended up in this slot next.
+        auto* swapped = new (temp) ItemType{std::move(slots[index])};
+        slots[index].~ItemType();
+        new (&slots[index]) ItemType{std::move(slots[i])};
+        slots[i].~ItemType();
+        new (&slots[i]) ItemType{std::move(*swapped)};
+        swapped->~ItemType();
+        control[index] = hash_h2(hash);
+        --i;
+      }
+    }
+  }
+
+private:
+  // The low 7 bits of the hash are stored in the control byte and the rest selects the first group
+  // to probe.
+  static ControlByte hash_h2(HashedValue hash) {
+    return static_cast<ControlByte>(hash & 0x7F);
+  }
+
+  // Visits the groups in a triangular sequence starting at the group selected by the hash.  With a
+  // power of two number of groups, every group is visited exactly once.
+  class ProbeSequence {
+  public:
+    ProbeSequence(HashedValue hash, MemSize group_count)
+      : mask_{group_count - 1}, group_{detail::fibonacci_index(hash >> 7) & mask_} {}
+
+    static ProbeSequence starting_at(MemSize group, MemSize group_count) {
+      ProbeSequence sequence{0, group_count};
+      sequence.group_ = group;
+      return sequence;
+    }
+
+    // Index of the first slot in the current group.
+    NU_NO_DISCARD MemSize offset() const {
+      return group_ * Group::WIDTH;
+    }
+
+    // Number of groups visited before the current one.
+    NU_NO_DISCARD MemSize probes() const {
+      return probes_;
+    }
+
+    void next() {
+      ++probes_;
+      group_ = (group_ + probes_) & mask_;
+    }
+
+  private:
+    MemSize mask_;
+    MemSize group_;
+    MemSize probes_ = 0;
+  };
+};
+
+// Robin Hood linear probing.  The control byte of a full slot holds the distance of its item from
+// the item's home slot plus one.  An insert takes the slot of any item that is closer to its home,
+// which keeps the variance of probe lengths low, and a lookup stops as soon as it passes a slot
+// whose item is closer to home than the key would be.  Removing an item shifts the items after it
+// back, so there are never any tombstones.
+struct RobinHoodProbing {
+  using ControlByte = detail::ControlByte;
+
+  static constexpr ControlByte EMPTY = 0;
+
+  static bool is_full(ControlByte control) {
+    return control != EMPTY;
+  }
+
+  static bool is_tombstone(ControlByte) {
+    return false;
+  }
+
+  // One bit for each of the `Group::WIDTH` slots from `control` that holds an item.
+  static U32 match_full(const ControlByte* control) {
+    return ~detail::Group{control}.match(EMPTY).bits() & ((1u << detail::Group::WIDTH) - 1);
+  }
+
+  // Probe lengths count slots, and every slot is the start of its own probe sequence.
+  static constexpr MemSize PROBE_START_STRIDE = 1;
+
+  // Number of slots a lookup for `hash` probes to find the item at `index`, but no more than
+  // `limit`.  The control byte already holds it, unless it is saturated.
+  static MemSize probe_length(const ControlByte* control, MemSize capacity, HashedValue hash,
+                              MemSize index, MemSize limit) {
+    MemSize length = control[index] != SATURATED
+                         ? control[index]
+                         : ((index - home_index(hash, capacity - 1)) & (capacity - 1)) + 1;
+    return std::min(length, limit);
+  }
+
+  // Number of slots a lookup that does not find anything probes if its home slot is `start`, but
+  // no more than `limit`.
+  static MemSize miss_probe_length(const ControlByte* control, MemSize capacity, MemSize start,
+                                   MemSize limit) {
+    MemSize mask = capacity - 1;
+    limit = std::min(limit, capacity);
+
+    for (MemSize distance = 0; distance < limit; ++distance) {
+      ControlByte current = control[(start + distance) & mask];
+      if (current == EMPTY || is_closer_to_home(current, distance)) {
+        return distance + 1;
+      }
+    }
+
+    return limit;
+  }
+
+  // The first slot a lookup for `hash` looks at.
+  static MemSize probe_start(MemSize capacity, HashedValue hash) {
+    return home_index(hash, capacity - 1);
+  }
+
+  template <typename ItemType, typename Predicate>
+  static MemSize find(const ControlByte* control, ItemType* slots, MemSize capacity,
+                      HashedValue hash, Predicate&& predicate) {
+    MemSize mask = capacity - 1;
+    MemSize index = home_index(hash, mask);
+
+    for (MemSize distance = 0; distance < capacity; ++distance) {
+      ControlByte current = control[index];
+      if (current == EMPTY || is_closer_to_home(current, distance)) {
+        break;
+      }
+
+      // Only items with the same home slot can match.
+      if ((current == SATURATED || current == to_control(distance)) && predicate(slots[index])) {
+        return index;
+      }
+
+      index = (index + 1) & mask;
+    }
+
+    return capacity;
+  }
+
+  // Finds the slot where an item with `hash` belongs and shifts the items from there on forward by
+  // one to make space for it.  There must be at least one empty slot.
+  template <typename ItemType>
+  static detail::InsertSlot prepare_insert(ControlByte* control, ItemType* slots, MemSize capacity,
+                                           HashedValue hash) {
+    MemSize mask = capacity - 1;
+    MemSize index = home_index(hash, mask);
+    MemSize distance = 0;
+
+    while (control[index] != EMPTY && !is_closer_to_home(control[index], distance)) {
+      index = (index + 1) & mask;
+      ++distance;
+      DCHECK(distance < capacity) << "No free slot in the table.";
+    }
+
+    if (control[index] != EMPTY) {
+      MemSize empty = index;
+      while (control[empty] != EMPTY) {
+        empty = (empty + 1) & mask;
+      }
+
+      for (MemSize to = empty; to != index;) {
+        MemSize from = (to - 1) & mask;
+        new (&slots[to]) ItemType{std::move(slots[from])};
+        slots[from].~ItemType();
+        control[to] = control[from] == SATURATED ? SATURATED : control[from] + 1;
+        to = from;
+      }
+
+      control[index] = EMPTY;
+    }
+
+    return {index, to_control(distance)};
+  }
+
+  // Destroys the item at `index` and shifts the items after it back until one is in its home slot.
+  // An item that wrapped around to the start of the table can be shifted back to the end.
+  template <typename ItemType, typename Hasher>
+  static detail::EraseResult erase(ControlByte* control, ItemType* slots, MemSize capacity,
+                                   MemSize index, Hasher&& hasher) {
+    MemSize mask = capacity - 1;
+
+    slots[index].~ItemType();
+
+    MemSize hole = index;
+    for (MemSize next = (hole + 1) & mask; control[next] > to_control(0);
+         next = (next + 1) & mask) {
+      new (&slots[hole]) ItemType{std::move(slots[next])};
+      slots[next].~ItemType();
+
+      if (control[next] == SATURATED) {
+        // The exact distance is not known any more, so work it out from the hash.
+        control[hole] = to_control((hole - home_index(hasher(slots[hole]), mask)) & mask);
+      } else {
+        control[hole] = control[next] - 1;
+      }
+
+      hole = next;
+    }
+
+    control[hole] = EMPTY;
+
+    return {false, hole};
+  }
+
+  // There are never any tombstones to remove.
+  template <typename ItemType, typename Hasher>
+  static void rehash_in_place(ControlByte*, ItemType*, MemSize, Hasher&&) {}
+
+private:
+  // Distances that don't fit in a control byte are stored as `SATURATED`, which lookups and inserts
+  // treat as "at least that far from home".
+  static constexpr ControlByte SATURATED = 0xFF;
+
+  static MemSize home_index(HashedValue hash, MemSize mask) {
+    return detail::fibonacci_index(hash) & mask;
+  }
+
+  static ControlByte to_control(MemSize distance) {
+    return distance + 1 >= SATURATED ? SATURATED : static_cast<ControlByte>(distance + 1);
+  }
+
+  // Returns true if the item described by `control` is closer to its home slot than `distance`.
+  static bool is_closer_to_home(ControlByte control, MemSize distance) {
+    return control != SATURATED && static_cast<MemSize>(control - 1) < distance;
+  }
+};
+
+}  // namespace nu
@@ -0,0 +1,50 @@
+#pragma once
+
+#include "nucleus/text/string_view.h"
+#include "nucleus/types.h"
+
+namespace nu {
+
+// A snapshot of how well the items of a hash table are spread out, see
+// `HashTableBase::statistics`.
+struct HashTableStatistics {
+  static constexpr MemSize PROBE_LENGTH_BUCKETS = 16;
+  static constexpr MemSize CLUSTER_SIZE_BUCKETS = 32;
+
+  // Probes are followed for at most this many steps, which keeps badly clustered tables from
+  // taking quadratic time.  Longer probes are counted as this long.
+  static constexpr MemSize MAX_PROBE_LENGTH = 1024;
+
+  // Misses are measured from at most this many positions, spread evenly over the table.
+  static constexpr MemSize MAX_MISS_SAMPLES = 4096;
+
+  MemSize size = 0;
+  MemSize capacity = 0;
+  MemSize tombstones = 0;
+  F32 load_factor = 0.0f;
+
+  // Probe lengths are counted in the steps the probing policy takes: groups for `GroupProbing` and
+  // slots for `RobinHoodProbing`.  Hits are measured for every item in the table and misses for a
+  // lookup starting at every position a probe sequence can start from, or at a sample of
+  // `MAX_MISS_SAMPLES` of them in large tables.
+  F64 average_hit_probe_length = 0.0;
+  MemSize max_hit_probe_length = 0;
+  F64 average_miss_probe_length = 0.0;
+  MemSize max_miss_probe_length = 0;
+
+  // Entry `i` counts lookups that took `i + 1` steps.  The last entry also counts everything
+  // longer.
+  MemSize hit_probe_lengths[PROBE_LENGTH_BUCKETS] = {};
+  MemSize miss_probe_lengths[PROBE_LENGTH_BUCKETS] = {};
+
+  // A cluster is a run of slots that hold either an item or a tombstone.  Entry `i` counts clusters
+  // of `2^i` up to `2^(i + 1) - 1` slots.
+  MemSize cluster_sizes[CLUSTER_SIZE_BUCKETS] = {};
+  MemSize max_cluster_size = 0;
+
+  // Sets a counter named "<prefix>.<statistic>" for each statistic on the current profile metrics.
+  // Does nothing when there is no `Profiling` object.
+  void export_to_profiling(StringView prefix) const;
+};
+
+}  // namespace nu
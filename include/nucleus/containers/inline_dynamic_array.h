@@ -0,0 +1,533 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include "nucleus/containers/array_view.h"
+#include "nucleus/containers/dynamic_array.h"
+#include "nucleus/logging.h"
+#include "nucleus/macros.h"
+#include "nucleus/memory/allocator.h"
+#include "nucleus/types.h"
+
+#undef free
+
+namespace nu {
+
+// A `DynamicArray` that keeps its first `InlineCapacity` elements inside the object itself and only
+// allocates once it grows beyond that.  Small arrays that are created and thrown away often, like
+// the attributes of a node or a batch of tasks, then never touch the heap.  It has the same
+// interface as `DynamicArray`, so the two can be swapped for each other.
+//
+// Unlike `DynamicArray`, moving or swapping an array that is still inline moves the elements one by
+// one, because they live inside the object.  Only memory beyond the inline elements comes from
+// `Allocator`.
+template <typename T, MemSize InlineCapacity = 8,
+          typename Allocator = MallocAllocator<AllocationTag::DynamicArray>>
+class InlineDynamicArray {
+  static_assert(InlineCapacity > 0, "Use DynamicArray when no elements should be stored inline.");
+
+public:
+  using ElementType = T;
+  using SizeType = MemSize;
+  using Iterator = ElementType*;
+  using ConstIterator = const ElementType*;
+
+  // Factory Methods
+
+  static InlineDynamicArray withInitialCapacity(SizeType initialCapacity,
+                                                const Allocator& allocator = Allocator{}) {
+    InlineDynamicArray result{allocator};
+
+    result.ensureAllocated(initialCapacity);
+
+    return result;
+  }
+
+  static InlineDynamicArray withInitialSize(SizeType initialSize,
+                                            const ElementType& value = ElementType{},
+                                            const Allocator& allocator = Allocator{}) {
+    InlineDynamicArray result{allocator};
+
+    result.ensureAllocated(initialSize);
+    std::uninitialized_fill(result.m_data, result.m_data + initialSize, value);
+    result.m_size = initialSize;
+
+    return result;
+  }
+
+  // Construct/destruct
+
+  InlineDynamicArray() = default;
+
+  explicit InlineDynamicArray(const Allocator& allocator) : m_allocator{allocator} {}
+
+  InlineDynamicArray(ElementType* data, SizeType size, const Allocator& allocator = Allocator{})
+    : m_allocator{allocator} {
+    ensureAllocated(size);
+    std::uninitialized_copy(data, data + size, m_data);
+    m_size = size;
+  }
+
+  InlineDynamicArray(const InlineDynamicArray& other) : m_allocator{other.m_allocator} {
+    ensureAllocated(other.m_size);
+    std::uninitialized_copy(other.m_data, other.m_data + other.m_size, m_data);
+    m_size = other.m_size;
+  }
+
+  InlineDynamicArray(InlineDynamicArray&& other) noexcept : m_allocator{other.m_allocator} {
+    take(other);
+  }
+
+  InlineDynamicArray(std::initializer_list<ElementType> list,
+                     const Allocator& allocator = Allocator{})
+    : m_allocator{allocator} {
+    ensureAllocated(list.size());
+    std::uninitialized_copy(list.begin(), list.end(), m_data);
+    m_size = list.size();
+  }
+
+  ~InlineDynamicArray() {
+    free();
+  }
+
+  // Operators
+
+  InlineDynamicArray& operator=(const InlineDynamicArray& other) {
+    if (this == &other) {
+      return *this;
+    }
+
+    removeAll();
+
+    ensureAllocated(other.m_size);
+    std::uninitialized_copy(other.m_data, other.m_data + other.m_size, m_data);
+    m_size = other.m_size;
+
+    return *this;
+  }
+
+  InlineDynamicArray& operator=(InlineDynamicArray&& other) noexcept {
+    if (this == &other) {
+      return *this;
+    }
+
+    free();
+    take(other);
+
+    return *this;
+  }
+
+  // State
+
+  SizeType size() const {
+    return m_size;
+  }
+
+  SizeType capacity() const {
+    return m_capacity;
+  }
+
+  bool empty() const {
+    return m_size == 0;
+  }
+
+  const Allocator& allocator() const {
+    return m_allocator;
+  }
+
+  // True while the elements are stored inside the object and nothing was allocated.
+  bool isInline() const {
+    return m_data == inlineData();
+  }
+
+  // Get
+
+  ArrayView<ElementType> view() const {
+    return ArrayView<T>{m_data, m_size};
+  }
+
+  ElementType* data() {
+    return m_data;
+  }
+
+  const ElementType* data() const {
+    return m_data;
+  }
+
+  const ElementType& operator[](SizeType index) const {
+    return m_data[index];
+  }
+
+  ElementType& operator[](SizeType index) {
+    return m_data[index];
+  }
+
+  const ElementType& last() const {
+    return m_data[m_size - 1];
+  }
+
+  ElementType& last() {
+    return m_data[m_size - 1];
+  }
+
+  // Push
+
+  using PushBackResult = typename DynamicArray<T>::PushBackResult;
+
+  PushBackResult pushBack(const ElementType& element) {
+    ensureAllocated(m_size + 1);
+
+    SizeType index = m_size++;
+    ElementType* storage = &m_data[index];
+
+    new (storage) ElementType(element);
+
+    return {storage, index};
+  }
+
+  PushBackResult pushBack(ElementType&& element) {
+    ensureAllocated(m_size + 1);
+
+    SizeType index = m_size++;
+    ElementType* storage = &m_data[index];
+
+    new (storage) ElementType(std::forward<ElementType>(element));
+
+    return {storage, index};
+  }
+
+  // Push back a range of elements.
+  void pushBack(ConstIterator begin, ConstIterator end) {
+    SizeType count = static_cast<SizeType>(end - begin);
+    ensureAllocated(m_size + count);
+
+    std::uninitialized_copy(begin, end, m_data + m_size);
+    m_size += count;
+  }
+
+  template <typename... Args>
+  PushBackResult emplaceBack(Args&&... args) {
+    ensureAllocated(m_size + 1);
+
+    SizeType index = m_size++;
+    ElementType* storage = &m_data[index];
+
+    new (storage) ElementType{std::forward<Args>(args)...};
+
+    return {storage, index};
+  }
+
+  template <typename Func>
+  PushBackResult constructBack(Func init) {
+    ensureAllocated(m_size + 1);
+
+    SizeType index = m_size++;
+    ElementType* storage = &m_data[index];
+
+    init(storage);
+
+    return {storage, index};
+  }
+
+  // Modify
+
+  void remove(Iterator pos) {
+    DCHECK(pos >= m_data && pos < m_data + m_size) << "Iterator out of bounds.";
+
+    remove(pos, pos + 1);
+  }
+
+  void remove(Iterator begin, Iterator end) {
+    DCHECK(begin >= m_data && begin <= end && end <= m_data + m_size) << "Range out of bounds.";
+
+    Iterator newEnd = std::move(end, m_data + m_size, begin);
+    destroy(newEnd, m_data + m_size);
+
+    m_size = static_cast<SizeType>(newEnd - m_data);
+  }
+
+  void remove(const ElementType& element) {
+    for (auto it = m_data; it != m_data + m_size; ++it) {
+      if (*it == element) {
+        remove(it);
+        return;
+      }
+    }
+  }
+
+  // Removes the element at `pos` by moving the last element into its place, so the order of the
+  // elements is not kept, but none of the other elements have to move.
+  void swapRemove(Iterator pos) {
+    DCHECK(pos >= m_data && pos < m_data + m_size) << "Iterator out of bounds.";
+
+    Iterator last = m_data + m_size - 1;
+    if (pos != last) {
+      *pos = std::move(*last);
+    }
+    destroy(last, m_data + m_size);
+
+    --m_size;
+  }
+
+  // Removes every element for which `predicate(element)` returns true.  The elements that are left
+  // are moved down in a single pass and keep their order.  Returns the number of elements removed.
+  template <typename Predicate>
+  SizeType removeIf(Predicate predicate) {
+    Iterator end = m_data + m_size;
+    Iterator newEnd = std::remove_if(m_data, end, predicate);
+    destroy(newEnd, end);
+
+    auto removed = static_cast<SizeType>(end - newEnd);
+    m_size -= removed;
+    return removed;
+  }
+
+  // Removes every element equal to `element`, which may not be one of the elements of this array.
+  SizeType removeAll(const ElementType& element) {
+    return removeIf([&element](const ElementType& candidate) {
+      return candidate == element;
+    });
+  }
+
+  // Keeps only the elements for which `predicate(element)` returns true.  Returns the number of
+  // elements removed.
+  template <typename Predicate>
+  SizeType retain(Predicate predicate) {
+    return removeIf([&predicate](const ElementType& element) {
+      return !predicate(element);
+    });
+  }
+
+  // Remove all the elements from the array, but keep the current capacity.
+  auto removeAll() -> void {
+    destroy(m_data, m_data + m_size);
+
+    m_size = 0;
+  }
+
+  void reserve(SizeType size) {
+    ensureAllocated(size);
+  }
+
+  // New elements are value initialized, so numbers are set to 0.
+  void resize(SizeType newSize) {
+    if (newSize < m_size) {
+      destroy(m_data + newSize, m_data + m_size);
+    } else {
+      ensureAllocated(newSize);
+      std::uninitialized_value_construct(m_data + m_size, m_data + newSize);
+    }
+
+    m_size = newSize;
+  }
+
+  void resize(SizeType newSize, const ElementType& fillValue) {
+    if (newSize < m_size) {
+      destroy(m_data + newSize, m_data + m_size);
+    } else {
+      ensureAllocated(newSize);
+      std::uninitialized_fill(m_data + m_size, m_data + newSize, fillValue);
+    }
+
+    m_size = newSize;
+  }
+
+  // Same as `resize`, but new elements are left uninitialized, for when they are about to be
+  // overwritten anyway, e.g. by reading into them.
+  void resize_uninitialized(SizeType newSize) {
+    static_assert(std::is_trivially_default_constructible_v<ElementType> &&
+                      std::is_trivially_destructible_v<ElementType>,
+                  "Only elements that need no initialization can be left uninitialized.");
+
+    ensureAllocated(newSize);
+    m_size = newSize;
+  }
+
+  void swap(InlineDynamicArray& other) {
+    if (this == &other) {
+      return;
+    }
+
+    if (!isInline() && !other.isInline()) {
+      using std::swap;
+
+      swap(m_data, other.m_data);
+      swap(m_size, other.m_size);
+      swap(m_capacity, other.m_capacity);
+      swap(m_allocator, other.m_allocator);
+      return;
+    }
+
+    InlineDynamicArray temp{std::move(other)};
+    other = std::move(*this);
+    *this = std::move(temp);
+  }
+
+  // Destroys all the elements and frees any allocated memory, so the array is inline again.
+  void clear() {
+    free();
+  }
+
+  // Iterators
+
+  Iterator begin() {
+    return m_data;
+  }
+
+  Iterator end() {
+    return m_data + m_size;
+  }
+
+  ConstIterator begin() const {
+    return m_data;
+  }
+
+  ConstIterator end() const {
+    return m_data + m_size;
+  }
+
+private:
+  ElementType* inlineData() {
+    return reinterpret_cast<ElementType*>(m_inline);
+  }
+
+  const ElementType* inlineData() const {
+    return reinterpret_cast<const ElementType*>(m_inline);
+  }
+
+  // Ensure that we can accommodate `elementsRequired` elements.
+  void ensureAllocated(SizeType elementsRequired) {
+    if (elementsRequired > m_capacity) {
+      // Grow the same way `DynamicArray` does, but starting from the inline capacity.
+      SizeType requiredCapacity = std::max<SizeType>(m_capacity * 2, 1 << 4);
+      while (requiredCapacity < elementsRequired) {
+        requiredCapacity <<= 1;
+      }
+
+      moveToHeap(requiredCapacity);
+    }
+  }
+
+  void moveToHeap(SizeType newCapacity) {
+    DCHECK(m_capacity < newCapacity);
+
+    MemSize bytesRequired = newCapacity * sizeof(ElementType);
+
+    if constexpr (IsTriviallyRelocatable<ElementType>::value) {
+      if (!isInline()) {
+        auto* newData = static_cast<ElementType*>(m_allocator.reallocate(
+            m_data, m_capacity * sizeof(ElementType), bytesRequired, alignof(ElementType)));
+        DCHECK(newData) << "Out of memory.";
+        m_data = newData;
+        m_capacity = newCapacity;
+        return;
+      }
+    }
+
+    auto* newData =
+        static_cast<ElementType*>(m_allocator.allocate(bytesRequired, alignof(ElementType)));
+    DCHECK(newData) << "Out of memory.";
+
+    relocate(m_data, m_data + m_size, newData);
+
+    if (!isInline()) {
+      m_allocator.deallocate(m_data, m_capacity * sizeof(ElementType));
+    }
+
+    m_data = newData;
+    m_capacity = newCapacity;
+  }
+
+  // Takes the elements of `other`, which is left empty and inline.  Assumes this array holds no
+  // elements and no memory.
+  void take(InlineDynamicArray& other) {
+    m_allocator = other.m_allocator;
+
+    if (other.isInline()) {
+      relocate(other.m_data, other.m_data + other.m_size, inlineData());
+      m_size = other.m_size;
+      other.m_size = 0;
+      return;
+    }
+
+    m_data = other.m_data;
+    m_size = other.m_size;
+    m_capacity = other.m_capacity;
+
+    other.m_data = other.inlineData();
+    other.m_size = 0;
+    other.m_capacity = InlineCapacity;
+  }
+
+  // Moves the elements in [begin, end) to uninitialized memory at `destination` and ends the
+  // lifetime of the originals.
+  static void relocate(ElementType* begin, ElementType* end, ElementType* destination) {
+    if constexpr (IsTriviallyRelocatable<ElementType>::value) {
+      if (begin != end) {
+        std::memcpy(static_cast<void*>(destination), begin,
+                    static_cast<MemSize>(end - begin) * sizeof(ElementType));
+      }
+    } else {
+      std::uninitialized_move(begin, end, destination);
+      destroy(begin, end);
+    }
+  }
+
+  static void destroy(ElementType* begin, ElementType* end) {
+    if constexpr (!std::is_trivially_destructible_v<ElementType>) {
+      for (ElementType* element = begin; element != end; ++element) {
+        element->~ElementType();
+      }
+    }
+  }
+
+  void free() {
+    destroy(m_data, m_data + m_size);
+
+    if (!isInline()) {
+      m_allocator.deallocate(m_data, m_capacity * sizeof(ElementType));
+      m_data = inlineData();
+    }
+
+    m_size = 0;
+    m_capacity = InlineCapacity;
+  }
+
+  // Storage for the elements until the array grows beyond `InlineCapacity`.
+  alignas(ElementType) U8 m_inline[sizeof(ElementType) * InlineCapacity];
+
+  // Points to either `m_inline` or the allocated elements.
+  ElementType* m_data = inlineData();
+
+  // Total amount of elements currently in the container.
+  SizeType m_size = 0;
+
+  // Total amount of elements that fit without allocating.
+  SizeType m_capacity = InlineCapacity;
+
+  NU_NO_UNIQUE_ADDRESS Allocator m_allocator;
+};
+
+}  // namespace nu
+
+template <typename T, MemSize InlineCapacity, typename Allocator>
+std::ostream& operator<<(std::ostream& os,
+                         const nu::InlineDynamicArray<T, InlineCapacity, Allocator>& value) {
+  os << '[';
+  auto size = value.size();
+  for (auto it = value.begin(), eit = value.end(); it != eit; ++it) {
+    os << *it;
+    if (size-- != 1) {
+      os << ", ";
+    }
+  }
+  os << ']';
+
+  return os;
+}
@@ -0,0 +1,111 @@
+#pragma once
+
+#include <atomic>
+#include <utility>
+
+#include "nucleus/containers/hash_map.h"
+#include "nucleus/synchronization/auto_lock.h"
+#include "nucleus/synchronization/epoch_domain.h"
+#include "nucleus/synchronization/lock.h"
+
+namespace nu {
+
+// A hash map for data that is read all the time and changed rarely.  Readers never lock or write
+// shared memory: a lookup is a single atomic load followed by a plain `HashMap` lookup.  Writers
+// copy the current map, change the copy and publish it, after which the old version is retired in
+// the `EpochDomain`.
+//
+// Anything a reader gets out of the map is only valid until its thread goes through its next
+// quiescent point, see `EpochDomain::Participant`.
+template <typename KeyType, typename ValueType>
+class ReadMostlyHashMap {
+  NU_DELETE_COPY_AND_MOVE(ReadMostlyHashMap);
+
+public:
+  using MapType = HashMap<KeyType, ValueType>;
+
+  explicit ReadMostlyHashMap(EpochDomain* domain) : domain_{domain}, current_{new MapType} {}
+
+  ~ReadMostlyHashMap() {
+    delete current_.load(std::memory_order_acquire);
+  }
+
+  // The current version of the map.
+  const MapType& snapshot() const {
+    return *current_.load(std::memory_order_acquire);
+  }
+
+  NU_NO_DISCARD MemSize size() const {
+    return snapshot().size();
+  }
+
+  bool contains_key(const KeyType& key) const {
+    return snapshot().contains_key(key);
+  }
+
+  // Calls `callback(const ValueType&)` with the value of `key`, if it is found.
+  template <typename Callback>
+  bool find(const KeyType& key, Callback&& callback) const {
+    auto result = snapshot().find(key);
+    if (!result.was_found()) {
+      return false;
+    }
+
+    callback(static_cast<const ValueType&>(result.value()));
+    return true;
+  }
+
+  // Copies the value of `key` into `value`, if it is found.
+  bool find(const KeyType& key, ValueType* value) const {
+    DCHECK(value);
+
+    return find(key, [value](const ValueType& found) {
+      *value = found;
+    });
+  }
+
+  // Calls `updater(MapType&)` with a copy of the current map and publishes the result.  Every
+  // update copies the whole map, so batch changes together where possible.
+  template <typename Updater>
+  void update(Updater&& updater) {
+    AutoLock<Lock> locker{write_lock_};
+
+    auto* old_map = current_.load(std::memory_order_relaxed);
+    auto* new_map = new MapType{*old_map};
+    updater(*new_map);
+
+    current_.store(new_map, std::memory_order_release);
+    domain_->retire(old_map);
+  }
+
+  // Returns true if the key was not in the map yet.  An existing value is replaced.
+  bool insert(const KeyType& key, ValueType value) {
+    bool is_new = false;
+    update([&](MapType& map) {
+      is_new = map.insert(key, std::move(value)).is_new();
+    });
+    return is_new;
+  }
+
+  // Returns true if the key was found and removed from the map.
+  bool remove(const KeyType& key) {
+    if (!contains_key(key)) {
+      return false;
+    }
+
+    bool removed = false;
+    update([&](MapType& map) {
+      removed = map.remove(key);
+    });
+    return removed;
+  }
+
+private:
+  EpochDomain* domain_;
+
+  // Only writers take this lock.
+  Lock write_lock_;
+  std::atomic<MapType*> current_;
+};
+
+}  // namespace nu
@@ -0,0 +1,220 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <new>
+#include <utility>
+
+#include "nucleus/bits.h"
+#include "nucleus/containers/array_view.h"
+#include "nucleus/logging.h"
+#include "nucleus/macros.h"
+#include "nucleus/memory/allocator.h"
+#include "nucleus/types.h"
+
+namespace nu {
+
+// An array that can only grow at the end and never moves its elements.  Memory comes in segments
+// that each hold twice as many elements as the one before, starting with `FirstSegmentSize`, so
+// growing only ever allocates the new segment.  Unlike `DynamicArray`, there is no moment where the
+// old and the new storage are both alive and every element is copied, and pointers to elements stay
+// valid for as long as the array lives.
+//
+// One thread at a time may add elements while any number of threads read the elements that were
+// already added.  An element is published once `size()` includes it, so readers must only look at
+// indices below a `size()` they loaded.  `clear` and destruction need all the readers to be done.
+template <typename T, MemSize FirstSegmentSize = 64,
+          typename Allocator = MallocAllocator<AllocationTag::DynamicArray>>
+class SegmentedArray {
+  NU_DELETE_COPY_AND_MOVE(SegmentedArray);
+
+  static_assert(is_power_of_two(FirstSegmentSize), "The first segment must be a power of two.");
+
+  static constexpr U32 log2(MemSize value) {
+    U32 result = 0;
+    while (value > 1) {
+      value >>= 1;
+      ++result;
+    }
+    return result;
+  }
+
+  static constexpr U32 FIRST_SEGMENT_SHIFT = log2(FirstSegmentSize);
+
+public:
+  using ElementType = T;
+  using SizeType = MemSize;
+
+  // Enough segments to hold every index that fits in a `MemSize`.
+  static constexpr MemSize MAX_SEGMENTS = sizeof(MemSize) * 8 - FIRST_SEGMENT_SHIFT;
+
+  // Construct/destruct
+
+  SegmentedArray() = default;
+
+  explicit SegmentedArray(const Allocator& allocator) : m_allocator{allocator} {}
+
+  ~SegmentedArray() {
+    clear();
+  }
+
+  // State
+
+  // The number of published elements.
+  SizeType size() const {
+    return m_size.load(std::memory_order_acquire);
+  }
+
+  bool empty() const {
+    return size() == 0;
+  }
+
+  // The number of elements that fit in the segments allocated so far.  Only for the thread that
+  // adds elements.
+  SizeType capacity() const {
+    return segmentStart(m_segmentCount);
+  }
+
+  const Allocator& allocator() const {
+    return m_allocator;
+  }
+
+  // Get
+
+  // Finds the segment from the highest set bit of the index, so there is no search.
+  ElementType& operator[](SizeType index) {
+    DCHECK(index < size()) << "Index out of bounds.";
+    auto location = locate(index);
+    return m_segments[location.segment][location.offset];
+  }
+
+  const ElementType& operator[](SizeType index) const {
+    DCHECK(index < size()) << "Index out of bounds.";
+    auto location = locate(index);
+    return m_segments[location.segment][location.offset];
+  }
+
+  ElementType& last() {
+    return operator[](size() - 1);
+  }
+
+  const ElementType& last() const {
+    return operator[](size() - 1);
+  }
+
+  // The number of segments that hold published elements.  Elements can be processed in bulk one
+  // segment at a time:
+  //
+  //   for (MemSize i = 0; i < array.segmentCount(); ++i) {
+  //     process(array.segment(i));
+  //   }
+  SizeType segmentCount() const {
+    SizeType currentSize = size();
+    return currentSize ? locate(currentSize - 1).segment + 1 : 0;
+  }
+
+  // The published elements of a segment.
+  ArrayView<ElementType> segment(SizeType index) const {
+    DCHECK(index < segmentCount()) << "Segment out of bounds.";
+
+    SizeType count = std::min(segmentSize(index), size() - segmentStart(index));
+    return ArrayView<ElementType>{m_segments[index], count};
+  }
+
+  // Insert
+
+  ElementType& pushBack(const ElementType& element) {
+    return emplaceBack(element);
+  }
+
+  ElementType& pushBack(ElementType&& element) {
+    return emplaceBack(std::move(element));
+  }
+
+  template <typename... Args>
+  ElementType& emplaceBack(Args&&... args) {
+    SizeType index = m_size.load(std::memory_order_relaxed);
+    auto location = locate(index);
+    ensureSegments(location.segment + 1);
+
+    auto* element = new (m_segments[location.segment] + location.offset)
+        ElementType(std::forward<Args>(args)...);
+
+    // Publish the element, and the segment it lives in, to readers.
+    m_size.store(index + 1, std::memory_order_release);
+
+    return *element;
+  }
+
+  // Modify
+
+  // Allocates the segments needed to hold `size` elements.
+  void reserve(SizeType size) {
+    if (size > 0) {
+      ensureSegments(locate(size - 1).segment + 1);
+    }
+  }
+
+  // Destroys all the elements and frees all the segments.
+  void clear() {
+    SizeType currentSize = m_size.load(std::memory_order_relaxed);
+
+    for (SizeType segment = 0; segment < m_segmentCount; ++segment) {
+      ElementType* data = m_segments[segment];
+      SizeType start = segmentStart(segment);
+      if (start < currentSize) {
+        std::destroy(data, data + std::min(segmentSize(segment), currentSize - start));
+      }
+
+      m_allocator.deallocate(data, segmentSize(segment) * sizeof(ElementType));
+      m_segments[segment] = nullptr;
+    }
+
+    m_segmentCount = 0;
+    m_size.store(0, std::memory_order_relaxed);
+  }
+
+private:
+  struct Location {
+    SizeType segment;
+    SizeType offset;
+  };
+
+  // Segment `n` starts at index `FirstSegmentSize * (2^n - 1)`, so after adding `FirstSegmentSize`
+  // to an index, its highest set bit is the segment and the bits below it are the offset.
+  static Location locate(SizeType index) {
+    SizeType biased = index + FirstSegmentSize;
+    U32 highestBit = static_cast<U32>(sizeof(SizeType) * 8 - 1) - count_leading_zeros(biased);
+    return {highestBit - FIRST_SEGMENT_SHIFT, biased - (SizeType{1} << highestBit)};
+  }
+
+  static SizeType segmentSize(SizeType segment) {
+    return FirstSegmentSize << segment;
+  }
+
+  static SizeType segmentStart(SizeType segment) {
+    return (FirstSegmentSize << segment) - FirstSegmentSize;
+  }
+
+  void ensureSegments(SizeType count) {
+    DCHECK(count <= MAX_SEGMENTS) << "Too many elements.";
+
+    while (m_segmentCount < count) {
+      MemSize bytes = segmentSize(m_segmentCount) * sizeof(ElementType);
+      auto* data = static_cast<ElementType*>(m_allocator.allocate(bytes, alignof(ElementType)));
+      DCHECK(data) << "Out of memory.";
+
+      m_segments[m_segmentCount++] = data;
+    }
+  }
+
+  // Readers only look at segments that hold published elements, and the release store of
+  // `m_size` makes the segment pointers visible along with the elements.
+  ElementType* m_segments[MAX_SEGMENTS] = {};
+  SizeType m_segmentCount = 0;
+  std::atomic<SizeType> m_size{0};
+  NU_NO_UNIQUE_ADDRESS Allocator m_allocator;
+};
+
+}  // namespace nu
@@ -0,0 +1,414 @@
+#pragma once
+
+#include <cstring>
+#include <memory>
+#include <new>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "nucleus/containers/array_view.h"
+#include "nucleus/containers/dynamic_array.h"
+#include "nucleus/logging.h"
+#include "nucleus/macros.h"
+#include "nucleus/memory/allocator.h"
+#include "nucleus/types.h"
+
+#undef free
+
+namespace nu {
+
+// The elements of one column of a `BasicSoAArray` that can be changed.  Converts to an
+// `ArrayView` for code that only reads them.
+template <typename T>
+class SoAColumn {
+public:
+  SoAColumn(T* data, MemSize size) : m_data{data}, m_size{size} {}
+
+  T* data() const {
+    return m_data;
+  }
+
+  MemSize size() const {
+    return m_size;
+  }
+
+  bool empty() const {
+    return m_size == 0;
+  }
+
+  T& operator[](MemSize index) const {
+    DCHECK(index < m_size) << "Index out of bounds.";
+    return m_data[index];
+  }
+
+  T* begin() const {
+    return m_data;
+  }
+
+  T* end() const {
+    return m_data + m_size;
+  }
+
+private:
+  T* m_data;
+  MemSize m_size;
+};
+
+// Refers to one row of a `BasicSoAArray`, with a field in every column.  Works with structured
+// bindings like a tuple of references:
+//
+//   auto [position, velocity] = particles[index];
+//   position += velocity;
+template <bool IsConst, typename... Ts>
+class SoARow {
+public:
+  template <MemSize I>
+  using FieldType = std::conditional_t<IsConst, const std::tuple_element_t<I, std::tuple<Ts...>>,
+                                       std::tuple_element_t<I, std::tuple<Ts...>>>;
+
+  SoARow(const std::tuple<Ts*...>* columns, MemSize index) : m_columns{columns}, m_index{index} {}
+
+  MemSize index() const {
+    return m_index;
+  }
+
+  template <MemSize I>
+  FieldType<I>& get() const {
+    return std::get<I>(*m_columns)[m_index];
+  }
+
+private:
+  const std::tuple<Ts*...>* m_columns;
+  MemSize m_index;
+};
+
+// Stores each field of its elements in a column of its own, so a `SoAArray<Vec3, Vec3, F32>`
+// keeps all the positions next to each other, then all the velocities, then all the masses.  Loops
+// that only touch a few of the fields then only pull those into the cache, instead of every field
+// of every element as with a `DynamicArray` of structs.
+//
+// All the columns share one allocation with a single size and capacity.  Each column starts on a
+// `COLUMN_ALIGNMENT` boundary, so it can be processed with aligned SIMD loads.
+template <typename Allocator, typename... Ts>
+class BasicSoAArray {
+  static_assert(sizeof...(Ts) > 0, "A SoAArray needs at least one column.");
+
+public:
+  using SizeType = MemSize;
+  using Row = SoARow<false, Ts...>;
+  using ConstRow = SoARow<true, Ts...>;
+
+  template <MemSize I>
+  using ColumnType = std::tuple_element_t<I, std::tuple<Ts...>>;
+
+  static constexpr MemSize COLUMN_COUNT = sizeof...(Ts);
+  static constexpr MemSize COLUMN_ALIGNMENT = 64;
+
+  static_assert(((alignof(Ts) <= COLUMN_ALIGNMENT) && ...), "Column alignment not supported.");
+
+  // Construct/destruct
+
+  BasicSoAArray() = default;
+
+  explicit BasicSoAArray(const Allocator& allocator) : m_allocator{allocator} {}
+
+  BasicSoAArray(const BasicSoAArray& other) : m_allocator{other.m_allocator} {
+    copyFrom(other, std::index_sequence_for<Ts...>{});
+  }
+
+  BasicSoAArray(BasicSoAArray&& other) noexcept : m_allocator{other.m_allocator} {
+    take(other);
+  }
+
+  ~BasicSoAArray() {
+    free();
+  }
+
+  // Operators
+
+  BasicSoAArray& operator=(const BasicSoAArray& other) {
+    if (this == &other) {
+      return *this;
+    }
+
+    removeAll();
+    copyFrom(other, std::index_sequence_for<Ts...>{});
+
+    return *this;
+  }
+
+  BasicSoAArray& operator=(BasicSoAArray&& other) noexcept {
+    if (this == &other) {
+      return *this;
+    }
+
+    free();
+    m_allocator = other.m_allocator;
+    take(other);
+
+    return *this;
+  }
+
+  // State
+
+  SizeType size() const {
+    return m_size;
+  }
+
+  SizeType capacity() const {
+    return m_capacity;
+  }
+
+  bool empty() const {
+    return m_size == 0;
+  }
+
+  const Allocator& allocator() const {
+    return m_allocator;
+  }
+
+  // Get
+
+  template <MemSize I>
+  ArrayView<ColumnType<I>> column() const {
+    return ArrayView<ColumnType<I>>{std::get<I>(m_columns), m_size};
+  }
+
+  template <MemSize I>
+  SoAColumn<ColumnType<I>> column() {
+    return SoAColumn<ColumnType<I>>{std::get<I>(m_columns), m_size};
+  }
+
+  Row operator[](SizeType index) {
+    DCHECK(index < m_size) << "Index out of bounds.";
+    return Row{&m_columns, index};
+  }
+
+  ConstRow operator[](SizeType index) const {
+    DCHECK(index < m_size) << "Index out of bounds.";
+    return ConstRow{&m_columns, index};
+  }
+
+  Row last() {
+    return operator[](m_size - 1);
+  }
+
+  ConstRow last() const {
+    return operator[](m_size - 1);
+  }
+
+  // Insert
+
+  // Adds a row with a value for each column.
+  Row pushBack(Ts... values) {
+    ensureAllocated(m_size + 1);
+    constructRow(m_size, std::index_sequence_for<Ts...>{}, std::move(values)...);
+
+    return Row{&m_columns, m_size++};
+  }
+
+  // Modify
+
+  void popBack() {
+    DCHECK(m_size > 0) << "No rows to remove.";
+
+    --m_size;
+    destroyRows(m_size, m_size + 1, std::index_sequence_for<Ts...>{});
+  }
+
+  // Removes the row at `index` by moving the last row into its place, so the order of the rows is
+  // not kept.
+  void swapRemove(SizeType index) {
+    DCHECK(index < m_size) << "Index out of bounds.";
+
+    if (index != m_size - 1) {
+      moveRow(m_size - 1, index, std::index_sequence_for<Ts...>{});
+    }
+    popBack();
+  }
+
+  // Remove all the rows from the array, but keep the current capacity.
+  void removeAll() {
+    destroyRows(0, m_size, std::index_sequence_for<Ts...>{});
+
+    m_size = 0;
+  }
+
+  void reserve(SizeType size) {
+    ensureAllocated(size);
+  }
+
+  // New rows are value initialized, so numbers are set to 0.
+  void resize(SizeType newSize) {
+    if (newSize < m_size) {
+      destroyRows(newSize, m_size, std::index_sequence_for<Ts...>{});
+    } else {
+      ensureAllocated(newSize);
+      std::apply(
+          [this, newSize](auto*... columns) {
+            (std::uninitialized_value_construct(columns + m_size, columns + newSize), ...);
+          },
+          m_columns);
+    }
+
+    m_size = newSize;
+  }
+
+  void swap(BasicSoAArray& other) {
+    using std::swap;
+
+    swap(m_memory, other.m_memory);
+    swap(m_columns, other.m_columns);
+    swap(m_size, other.m_size);
+    swap(m_capacity, other.m_capacity);
+    swap(m_allocator, other.m_allocator);
+  }
+
+  void clear() {
+    free();
+  }
+
+private:
+  static MemSize alignUp(MemSize value) {
+    return (value + COLUMN_ALIGNMENT - 1) & ~(COLUMN_ALIGNMENT - 1);
+  }
+
+  // Every column rounded up to the alignment, plus room to align the start of the memory, because
+  // allocators only guarantee `alignof(std::max_align_t)`.
+  static MemSize allocationSize(SizeType capacity) {
+    return (alignUp(capacity * sizeof(Ts)) + ...) + COLUMN_ALIGNMENT;
+  }
+
+  static std::tuple<Ts*...> layoutColumns(U8* memory, SizeType capacity) {
+    std::tuple<Ts*...> result;
+
+    MemSize address = alignUp(reinterpret_cast<MemSize>(memory));
+    std::apply(
+        [&address, capacity](auto*&... columns) {
+          ((columns = reinterpret_cast<std::remove_reference_t<decltype(*columns)>*>(address),
+            address = alignUp(address + capacity * sizeof(*columns))),
+           ...);
+        },
+        result);
+
+    return result;
+  }
+
+  void ensureAllocated(SizeType rowsRequired) {
+    if (rowsRequired <= m_capacity) {
+      return;
+    }
+
+    SizeType newCapacity = m_capacity ? m_capacity : 16;
+    while (newCapacity < rowsRequired) {
+      newCapacity <<= 1;
+    }
+
+    auto* memory = static_cast<U8*>(
+        m_allocator.allocate(allocationSize(newCapacity), alignof(std::max_align_t)));
+    DCHECK(memory) << "Out of memory.";
+
+    auto columns = layoutColumns(memory, newCapacity);
+    relocateColumns(columns, std::index_sequence_for<Ts...>{});
+
+    if (m_memory) {
+      m_allocator.deallocate(m_memory, allocationSize(m_capacity));
+    }
+
+    m_memory = memory;
+    m_columns = columns;
+    m_capacity = newCapacity;
+  }
+
+  // Moves all the rows to `columns` and ends the lifetime of the originals.
+  template <std::size_t... Is>
+  void relocateColumns(const std::tuple<Ts*...>& columns, std::index_sequence<Is...>) {
+    (relocate(std::get<Is>(m_columns), m_size, std::get<Is>(columns)), ...);
+  }
+
+  template <typename T>
+  static void relocate(T* source, SizeType count, T* destination) {
+    if constexpr (IsTriviallyRelocatable<T>::value) {
+      if (count > 0) {
+        std::memcpy(static_cast<void*>(destination), source, count * sizeof(T));
+      }
+    } else {
+      std::uninitialized_move(source, source + count, destination);
+      std::destroy(source, source + count);
+    }
+  }
+
+  template <std::size_t... Is>
+  void constructRow(SizeType index, std::index_sequence<Is...>, Ts&&... values) {
+    (new (std::get<Is>(m_columns) + index) Ts(std::move(values)), ...);
+  }
+
+  template <std::size_t... Is>
+  void moveRow(SizeType from, SizeType to, std::index_sequence<Is...>) {
+    ((std::get<Is>(m_columns)[to] = std::move(std::get<Is>(m_columns)[from])), ...);
+  }
+
+  template <std::size_t... Is>
+  void destroyRows(SizeType begin, SizeType end, std::index_sequence<Is...>) {
+    (std::destroy(std::get<Is>(m_columns) + begin, std::get<Is>(m_columns) + end), ...);
+  }
+
+  template <std::size_t... Is>
+  void copyFrom(const BasicSoAArray& other, std::index_sequence<Is...>) {
+    ensureAllocated(other.m_size);
+    (std::uninitialized_copy(std::get<Is>(other.m_columns),
+                             std::get<Is>(other.m_columns) + other.m_size, std::get<Is>(m_columns)),
+     ...);
+    m_size = other.m_size;
+  }
+
+  // Takes the rows of `other`, which is left empty.  Assumes this array holds no rows and no
+  // memory.
+  void take(BasicSoAArray& other) {
+    m_memory = other.m_memory;
+    m_columns = other.m_columns;
+    m_size = other.m_size;
+    m_capacity = other.m_capacity;
+
+    other.m_memory = nullptr;
+    other.m_columns = {};
+    other.m_size = 0;
+    other.m_capacity = 0;
+  }
+
+  void free() {
+    removeAll();
+
+    if (m_memory) {
+      m_allocator.deallocate(m_memory, allocationSize(m_capacity));
+      m_memory = nullptr;
+    }
+
+    m_columns = {};
+    m_capacity = 0;
+  }
+
+  U8* m_memory = nullptr;
+  std::tuple<Ts*...> m_columns;
+  SizeType m_size = 0;
+  SizeType m_capacity = 0;
+  NU_NO_UNIQUE_ADDRESS Allocator m_allocator;
+};
+
+template <typename... Ts>
+using SoAArray = BasicSoAArray<MallocAllocator<AllocationTag::DynamicArray>, Ts...>;
+
+}  // namespace nu
+
+namespace std {
+
+template <bool IsConst, typename... Ts>
+struct tuple_size<nu::SoARow<IsConst, Ts...>> : integral_constant<size_t, sizeof...(Ts)> {};
+
+template <size_t I, bool IsConst, typename... Ts>
+struct tuple_element<I, nu::SoARow<IsConst, Ts...>> {
+  using type = typename nu::SoARow<IsConst, Ts...>::template FieldType<I>;
+};
+
+}  // namespace std
@@ -0,0 +1,266 @@
+#pragma once
+
+#include <type_traits>
+#include <utility>
+
+#include "nucleus/containers/hash_map.h"
+#include "nucleus/containers/stable_pool.h"
+
+namespace nu {
+
+namespace detail {
+
+// What the index table of a `StableHashMap` stores for each item: where the item lives in the pool
+// and its hash, so the table can grow without touching the items.
+struct StableHashMapSlot {
+  U32 index;
+  HashedValue hash;
+};
+
+struct StableHashMapSlotTraits {
+  static HashedValue hashed(const StableHashMapSlot& slot) {
+    return slot.hash;
+  }
+
+  static bool equals(const StableHashMapSlot& left, const StableHashMapSlot& right) {
+    return left.index == right.index;
+  }
+};
+
+}  // namespace detail
+
+// A hash map where items never move.  The items live in a `StablePool` and the hash table only
+// holds small references to them, so pointers to keys and values stay valid when the map grows and
+// until the item is removed.  Lookups do one more indirection than `HashMap`.
+template <typename KeyType, typename ValueType, typename ProbingPolicy = GroupProbing,
+          MemSize PoolSize = 64>
+class StableHashMap : private HashTableBase<detail::StableHashMapSlot,
+                                            detail::StableHashMapSlotTraits, ProbingPolicy> {
+  using Base =
+      HashTableBase<detail::StableHashMapSlot, detail::StableHashMapSlotTraits, ProbingPolicy>;
+  using Slot = detail::StableHashMapSlot;
+
+public:
+  using ItemType = HashMapItem<KeyType, ValueType>;
+
+  class Iterator {
+  public:
+    ItemType& operator*() const {
+      return map_->pool_.at((*it_).index);
+    }
+
+    ItemType* operator->() const {
+      return &map_->pool_.at((*it_).index);
+    }
+
+    Iterator& operator++() {
+      ++it_;
+      return *this;
+    }
+
+    friend bool operator==(const Iterator& left, const Iterator& right) {
+      return left.it_ == right.it_;
+    }
+
+    friend bool operator!=(const Iterator& left, const Iterator& right) {
+      return left.it_ != right.it_;
+    }
+
+  private:
+    friend class StableHashMap;
+
+    Iterator(const StableHashMap* map, typename Base::Iterator it) : map_{map}, it_{it} {}
+
+    const StableHashMap* map_;
+    typename Base::Iterator it_;
+  };
+
+  StableHashMap() = default;
+
+  ~StableHashMap() = default;
+
+  NU_DELETE_COPY_AND_MOVE(StableHashMap);
+
+  using Base::capacity;
+  using Base::empty;
+  using Base::max_load_factor;
+  using Base::set_max_load_factor;
+  using Base::size;
+  using Base::statistics;
+
+  Iterator begin() const {
+    return Iterator{this, Base::begin()};
+  }
+
+  Iterator end() const {
+    return Iterator{this, Base::end()};
+  }
+
+  void clear() {
+    Base::clear();
+    pool_.clear();
+  }
+
+  // Removes the item `it` points to and returns an iterator to the next item.
+  Iterator erase(Iterator it) {
+    pool_.remove_at((*it.it_).index);
+    return Iterator{this, Base::erase(it.it_)};
+  }
+
+  class InsertResult {
+  public:
+    NU_NO_DISCARD bool is_new() const {
+      return is_new_;
+    }
+
+    KeyType& key() {
+      return *key_;
+    }
+
+    ValueType& value() {
+      return *value_;
+    }
+
+  private:
+    friend StableHashMap;
+
+    InsertResult(bool is_new, KeyType* key, ValueType* value)
+      : is_new_{is_new}, key_{key}, value_{value} {}
+
+    bool is_new_;
+    KeyType* key_;
+    ValueType* value_;
+  };
+
+  // Inserting a key that is already in the map assigns the new value to the existing item, so
+  // pointers to it stay valid.
+  InsertResult insert(const KeyType& key, ValueType value) {
+    return insert_with_hash(Hash<KeyType>::hashed(key), key, std::move(value));
+  }
+
+  // Same as `insert`, but with the hash of `key` already calculated.
+  InsertResult insert_with_hash(HashedValue hash, const KeyType& key, ValueType value) {
+    DCHECK(hash == Hash<KeyType>::hashed(key)) << "Hash does not match the key.";
+
+    auto bucket = this->find_bucket_for_writing(hash, matcher(hash, key));
+    DCHECK(bucket) << "Could not find a bucket for writing.";
+
+    if (bucket.is_used()) {
+      auto& item = pool_.at(bucket.reference().index);
+      item.value = std::move(value);
+      return {false, &item.key, &item.value};
+    }
+
+    auto index = pool_.insert_indexed(ItemType{key, std::move(value)});
+    bucket.set(Slot{index, hash});
+    ++this->size_;
+
+    auto& item = pool_.at(index);
+    return {true, &item.key, &item.value};
+  }
+
+  bool contains_key(const KeyType& key) const {
+    return find(key).was_found();
+  }
+
+  template <typename LookupType, typename = EnableIfHashCompatible<KeyType, LookupType>>
+  bool contains_key(const LookupType& key) const {
+    return find(key).was_found();
+  }
+
+  class FindResult {
+  public:
+    bool was_found() const {
+      return was_found_;
+    }
+
+    const KeyType& key() const {
+      DCHECK(key_);
+      return *key_;
+    }
+
+    ValueType& value() const {
+      DCHECK(value_);
+      return *value_;
+    }
+
+  private:
+    friend class StableHashMap;
+
+    FindResult(bool was_found, KeyType* key, ValueType* value)
+      : was_found_{was_found}, key_{key}, value_{value} {}
+
+    bool was_found_;
+    KeyType* key_;
+    ValueType* value_;
+  };
+
+  FindResult find(const KeyType& key) const {
+    return find_with_hash(Hash<KeyType>::hashed(key), key);
+  }
+
+  template <typename LookupType, typename = EnableIfHashCompatible<KeyType, LookupType>>
+  FindResult find(const LookupType& key) const {
+    return find_with_hash(Hash<LookupType>::hashed(key), key);
+  }
+
+  // Same as `find`, but with the hash of `key` already calculated.
+  template <typename LookupType>
+  FindResult find_with_hash(HashedValue hash, const LookupType& key) const {
+    static_assert(
+        std::is_same_v<KeyType, LookupType> || IsHashCompatible<KeyType, LookupType>::value,
+        "Lookup type is not hash compatible with the key type.");
+    DCHECK(hash == Hash<LookupType>::hashed(key)) << "Hash does not match the key.";
+
+    auto bucket = this->find_bucket_for_reading(hash, matcher(hash, key));
+    if (!bucket) {
+      return {false, nullptr, nullptr};
+    }
+
+    auto& item = pool_.at(bucket.reference().index);
+    return {true, &item.key, &item.value};
+  }
+
+  // Returns true if the key was found and removed from the map.
+  bool remove(const KeyType& key) {
+    return remove_with_hash(Hash<KeyType>::hashed(key), key);
+  }
+
+  template <typename LookupType, typename = EnableIfHashCompatible<KeyType, LookupType>>
+  bool remove(const LookupType& key) {
+    return remove_with_hash(Hash<LookupType>::hashed(key), key);
+  }
+
+  // Same as `remove`, but with the hash of `key` already calculated.
+  template <typename LookupType>
+  bool remove_with_hash(HashedValue hash, const LookupType& key) {
+    static_assert(
+        std::is_same_v<KeyType, LookupType> || IsHashCompatible<KeyType, LookupType>::value,
+        "Lookup type is not hash compatible with the key type.");
+    DCHECK(hash == Hash<LookupType>::hashed(key)) << "Hash does not match the key.";
+
+    auto bucket = this->find_bucket_for_reading(hash, matcher(hash, key));
+    if (!bucket) {
+      return false;
+    }
+
+    pool_.remove_at(bucket.reference().index);
+    this->erase_bucket(bucket);
+
+    return true;
+  }
+
+private:
+  // Comparing the full hash first means the items, which are somewhere else in memory, are only
+  // touched when they are very likely to match.
+  template <typename LookupType>
+  auto matcher(HashedValue hash, const LookupType& key) const {
+    return [this, hash, &key](Slot& slot) {
+      return slot.hash == hash && pool_.at(slot.index).key == key;
+    };
+  }
+
+  mutable StablePool<ItemType, PoolSize> pool_;
+};
+
+}  // namespace nu
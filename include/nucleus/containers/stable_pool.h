@@ -1,25 +1,34 @@
 #pragma once
 
+#include <cstdlib>
+#include <new>
+#include <utility>
+
+#include "nucleus/bits.h"
+#include "nucleus/containers/dynamic_array.h"
 #include "nucleus/logging.h"
+#include "nucleus/macros.h"
+#include "nucleus/memory/allocator.h"
 
 namespace nu {
 
 // StablePool stores T's with the following guarantees:
 // - once an object is inserted, it's pointer will never change.
 // - items will be tightly packed.
-template <typename T, MemSize PoolSize = 16>
+// Every object also has an index that stays the same for as long as it lives, which is a compact
+// way of referring to it.  The pools, and the array of pointers to them, come from `Allocator`.
+template <typename T, MemSize PoolSize = 16,
+          typename Allocator = MallocAllocator<AllocationTag::StablePool>>
 class StablePool {
 public:
+  using Index = U32;
+
   StablePool() = default;
 
+  explicit StablePool(const Allocator& allocator) : allocator_{allocator}, pools_{allocator} {}
+
   ~StablePool() {
-    Pool* pool = first_pool_;
-    while (pool) {
-      pool->clear();
-      Pool* current = pool;
-      pool = pool->next;
-      std::free(current);
-    }
+    clear();
   }
 
   MemSize size() const {
@@ -27,34 +36,49 @@ public:
   }
 
   MemSize capacity() const {
-    return capacity_;
+    return pools_.size() * PoolSize;
   }
 
   template <typename... Args>
   T* construct(Args&&... args) {
-    T* slot = get_slot_for_writing();
-
-    new (slot) T(std::forward<Args>(args)...);
-
-    size_ += 1;
-
-    return slot;
+    return &at(construct_indexed(std::forward<Args>(args)...));
   }
 
   T* insert(T&& item) {
-    T* slot = get_slot_for_writing();
+    return &at(insert_indexed(std::forward<T>(item)));
+  }
 
-    new (slot) T(std::forward<T>(item));
+  // Same as `construct`, but returns the index of the new object.
+  template <typename... Args>
+  Index construct_indexed(Args&&... args) {
+    Index index = get_slot_for_writing();
+    new (pointer_at(index)) T(std::forward<Args>(args)...);
+    return index;
+  }
 
-    size_ += 1;
+  // Same as `insert`, but returns the index of the new object.
+  Index insert_indexed(T&& item) {
+    Index index = get_slot_for_writing();
+    new (pointer_at(index)) T(std::forward<T>(item));
+    return index;
+  }
+
+  T& at(Index index) {
+    DCHECK(pools_[index / PoolSize]->is_occupied(index % PoolSize));
+    return *pointer_at(index);
+  }
 
-    return slot;
+  const T& at(Index index) const {
+    DCHECK(pools_[index / PoolSize]->is_occupied(index % PoolSize));
+    return *pointer_at(index);
   }
 
   bool remove(T* ptr) {
-    for (auto* pool = first_pool_; pool; pool = pool->next) {
-      if (pool->contains(ptr)) {
-        pool->remove(ptr);
+    for (MemSize i = 0; i < pools_.size(); ++i) {
+      if (pools_[i]->contains(ptr)) {
+        auto offset = reinterpret_cast<MemSize>(ptr) - reinterpret_cast<MemSize>(pools_[i]->data);
+        DCHECK(offset % sizeof(T) == 0);
+        remove_at(static_cast<Index>(i * PoolSize + offset / sizeof(T)));
         return true;
       }
     }
@@ -62,32 +86,55 @@ public:
     return false;
   }
 
+  void remove_at(Index index) {
+    MemSize pool_index = index / PoolSize;
+    pools_[pool_index]->remove(index % PoolSize);
+
+    size_ -= 1;
+    if (pool_index < first_open_pool_) {
+      first_open_pool_ = pool_index;
+    }
+  }
+
+  // Destroy all the objects and free all the pools.
+  void clear() {
+    for (auto* pool : pools_) {
+      pool->clear();
+      allocator_.deallocate(pool, sizeof(Pool));
+    }
+    pools_.clear();
+
+    size_ = 0;
+    first_open_pool_ = 0;
+  }
+
 private:
   static_assert(PoolSize >= 8 && PoolSize <= 64 && PoolSize % 8 == 0,
                 "Allowed sizes are 8, 16, 24, 32, 40, 48, 56, 64");
+
+  static constexpr U64 ALL_OCCUPIED = PoolSize == 64 ? ~0ull : (1ull << PoolSize) - 1;
+
   struct Pool {
-    U8 data[sizeof(T) * PoolSize];
-    // TODO: This can be a smaller type.
-    MemSize occupied;
-    Pool* next;
+    alignas(T) U8 data[sizeof(T) * PoolSize];
+    U64 occupied;
 
     bool is_occupied(MemSize index) const {
       DCHECK(index < PoolSize);
-      return (occupied & (static_cast<MemSize>(1) << index)) != 0;
+      return (occupied & (1ull << index)) != 0;
     }
 
     void occupy(MemSize index) {
       DCHECK(index < PoolSize);
-      occupied |= (static_cast<MemSize>(1) << index);
+      occupied |= (1ull << index);
     }
 
     void vacate(MemSize index) {
       DCHECK(index < PoolSize);
-      occupied &= ~(static_cast<MemSize>(1) << index);
+      occupied &= ~(1ull << index);
     }
 
     bool has_open_slots() const {
-      return occupied != static_cast<MemSize>(1) << PoolSize;
+      return occupied != ALL_OCCUPIED;
     }
 
     T* at(MemSize index) {
@@ -95,15 +142,13 @@ private:
       return reinterpret_cast<T*>(&data[index * sizeof(T)]);
     }
 
-    T* get_slot_for_writing() {
-      for (MemSize i = 0; i < PoolSize; ++i) {
-        if (!is_occupied(i)) {
-          occupy(i);
-          return at(i);
-        }
-      }
+    // Returns the index of a free slot and marks it as occupied.
+    MemSize get_slot_for_writing() {
+      DCHECK(has_open_slots());
 
-      return nullptr;
+      MemSize index = count_trailing_zeros(~occupied);
+      occupy(index);
+      return index;
     }
 
     void clear() {
@@ -112,6 +157,7 @@ private:
           at(i)->~T();
         }
       }
+      occupied = 0;
     }
 
     bool contains(T* ptr) const {
@@ -120,48 +166,50 @@ private:
       return ptr_addr >= data_addr && ptr_addr < data_addr + PoolSize * sizeof(T);
     }
 
-    void remove(T* ptr) {
-      DCHECK(contains(ptr));
-      PtrDiff index = reinterpret_cast<MemSize>(ptr) - reinterpret_cast<MemSize>(data);
-      DCHECK(index % sizeof(T) == 0);
-      index /= sizeof(T);
-      vacate(index);
+    void remove(MemSize index) {
+      DCHECK(is_occupied(index));
       at(index)->~T();
+      vacate(index);
     }
   };
 
   Pool* allocate_pool() {
-    auto* new_pool = static_cast<Pool*>(std::malloc(sizeof(Pool)));
+    auto* new_pool = static_cast<Pool*>(allocator_.allocate(sizeof(Pool), alignof(Pool)));
+    DCHECK(new_pool) << "Out of memory.";
     new_pool->occupied = 0;
-    new_pool->next = nullptr;
     return new_pool;
   }
 
-  T* get_slot_for_writing() {
-    T* slot = nullptr;
+  T* pointer_at(Index index) const {
+    DCHECK(index / PoolSize < pools_.size());
+    return pools_[index / PoolSize]->at(index % PoolSize);
+  }
 
-    if (size_ < capacity_) {
-      for (Pool* pool = first_pool_; pool; pool = pool->next) {
-        if (pool->has_open_slots()) {
-          slot = pool->get_slot_for_writing();
-        }
-      }
-    } else {
-      Pool* new_pool = allocate_pool();
-      new_pool->next = first_pool_;
-      first_pool_ = new_pool;
-      capacity_ += PoolSize;
-      slot = first_pool_->get_slot_for_writing();
+  Index get_slot_for_writing() {
+    // Pools before `first_open_pool_` are known to be full.
+    while (first_open_pool_ < pools_.size() && !pools_[first_open_pool_]->has_open_slots()) {
+      ++first_open_pool_;
     }
 
-    DCHECK(slot != nullptr);
+    if (first_open_pool_ == pools_.size()) {
+      DCHECK(capacity() + PoolSize <= static_cast<MemSize>(static_cast<Index>(-1)))
+          << "Too many objects for the index type.";
+      pools_.pushBack(allocate_pool());
+    }
+
+    MemSize offset = pools_[first_open_pool_]->get_slot_for_writing();
+
+    size_ += 1;
 
-    return slot;
+    return static_cast<Index>(first_open_pool_ * PoolSize + offset);
   }
 
+  NU_NO_UNIQUE_ADDRESS Allocator allocator_;
   MemSize size_ = 0;
-  MemSize capacity_ = 0;
-  Pool* first_pool_ = nullptr;
+  // Index of the first pool that might have open slots.
+  MemSize first_open_pool_ = 0;
+  // Pools are never moved, only the array of pointers to them grows.
+  DynamicArray<Pool*, Allocator> pools_;
 };
 
 }  // namespace nu
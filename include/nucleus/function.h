@@ -32,7 +32,7 @@ public:
   }
 
   NU_NO_DISCARD bool empty() const {
-    return wrapper_;
+    return !wrapper_;
   }
 
   Ret operator()(Args... args) const {
@@ -1,10 +1,21 @@
 #pragma once
 
+#include <bit>
+#include <cstring>
+#include <type_traits>
+
 #include "nucleus/types.h"
 
 namespace nu {
 
+// Hash tables store and compare 32-bit hashes unless `NU_HASHED_VALUE_64` is defined, see the
+// `NUCLEUS_HASHED_VALUE_64` CMake option.  64-bit hashes make full-hash comparisons practically
+// collision free in very large tables at the cost of larger slots where the hash is stored.
+#if defined(NU_HASHED_VALUE_64)
+using HashedValue = U64;
+#else
 using HashedValue = U32;
+#endif
 
 constexpr HashedValue hash_dword(U32 key) {
   key += ~(key << 15);
@@ -39,9 +50,222 @@ constexpr HashedValue double_hash(HashedValue key) {
   return key;
 }
 
+namespace detail {
+
+constexpr U64 HASH_SECRET[] = {0x2d358dccaa6c78a5ull, 0x8bb84b93962eacc9ull,
+                               0x4b33a62ed433d4a3ull, 0x4d5a2da51de1aa47ull};
+
+// Multiplies `a` and `b` into 128 bits.
+constexpr void multiply_128(U64 a, U64 b, U64* low, U64* high) {
+#if defined(__SIZEOF_INT128__)
+  __extension__ typedef unsigned __int128 U128;
+  U128 product = static_cast<U128>(a) * b;
+  *low = static_cast<U64>(product);
+  *high = static_cast<U64>(product >> 64);
+#else
+  U64 a_low = a & 0xFFFFFFFF;
+  U64 a_high = a >> 32;
+  U64 b_low = b & 0xFFFFFFFF;
+  U64 b_high = b >> 32;
+
+  U64 low_low = a_low * b_low;
+  U64 high_low = a_high * b_low;
+  U64 middle = (low_low >> 32) + (high_low & 0xFFFFFFFF) + a_low * b_high;
+
+  *low = (middle << 32) | (low_low & 0xFFFFFFFF);
+  *high = a_high * b_high + (high_low >> 32) + (middle >> 32);
+#endif
+}
+
+// Multiplies `a` and `b` into 128 bits and folds the high half into the low half.
+constexpr U64 hash_mix(U64 a, U64 b) {
+  U64 low = 0;
+  U64 high = 0;
+  multiply_128(a, b, &low, &high);
+  return low ^ high;
+}
+
+// Little endian loads.  Byte by byte when evaluated at compile time, where the bytes can not be
+// reinterpreted, and a single unaligned load otherwise.
+template <typename T>
+constexpr T hash_read(const char* data) {
+#if ARCH(CPU_LITTLE_ENDIAN)
+  if (!std::is_constant_evaluated()) {
+    T value;
+    std::memcpy(&value, data, sizeof(T));
+    return value;
+  }
+#endif
+
+  T value = 0;
+  for (MemSize i = 0; i < sizeof(T); ++i) {
+    value |= static_cast<T>(static_cast<U8>(data[i])) << (i * 8);
+  }
+  return value;
+}
+
+// Reads 1 to 3 bytes, each at least once.
+constexpr U64 hash_read_small(const char* data, MemSize length) {
+  return (static_cast<U64>(static_cast<U8>(data[0])) << 16) |
+         (static_cast<U64>(static_cast<U8>(data[length >> 1])) << 8) |
+         static_cast<U64>(static_cast<U8>(data[length - 1]));
+}
+
+}  // namespace detail
+
+// Hashes `length` bytes into 64 bits, 8 or 16 bytes at a time.  This is wyhash: inputs up to 16
+// bytes are hashed without a loop and longer inputs run three independent multiply chains per 48
+// bytes, which keeps the multipliers busy.  It gives the same result at compile time and at run
+// time, so hashes of constant keys can be calculated up front.
+constexpr U64 hash_bytes(const char* data, MemSize length, U64 seed = 0) {
+  using detail::hash_mix;
+  using detail::hash_read;
+  using detail::HASH_SECRET;
+
+  seed ^= hash_mix(seed ^ HASH_SECRET[0], HASH_SECRET[1]);
+
+  U64 a = 0;
+  U64 b = 0;
+  if (length <= 16) {
+    if (length >= 4) {
+      MemSize offset = (length >> 3) << 2;
+      a = (static_cast<U64>(hash_read<U32>(data)) << 32) | hash_read<U32>(data + offset);
+      b = (static_cast<U64>(hash_read<U32>(data + length - 4)) << 32) |
+          hash_read<U32>(data + length - 4 - offset);
+    } else if (length > 0) {
+      a = detail::hash_read_small(data, length);
+    }
+  } else {
+    const char* current = data;
+    MemSize remaining = length;
+    if (remaining > 48) {
+      U64 seed_1 = seed;
+      U64 seed_2 = seed;
+      do {
+        seed = hash_mix(hash_read<U64>(current) ^ HASH_SECRET[1],
+                        hash_read<U64>(current + 8) ^ seed);
+        seed_1 = hash_mix(hash_read<U64>(current + 16) ^ HASH_SECRET[2],
+                          hash_read<U64>(current + 24) ^ seed_1);
+        seed_2 = hash_mix(hash_read<U64>(current + 32) ^ HASH_SECRET[3],
+                          hash_read<U64>(current + 40) ^ seed_2);
+        current += 48;
+        remaining -= 48;
+      } while (remaining > 48);
+      seed ^= seed_1 ^ seed_2;
+    }
+
+    while (remaining > 16) {
+      seed = hash_mix(hash_read<U64>(current) ^ HASH_SECRET[1], hash_read<U64>(current + 8) ^ seed);
+      current += 16;
+      remaining -= 16;
+    }
+
+    // The last 16 bytes, which may overlap bytes that were already hashed.
+    a = hash_read<U64>(current + remaining - 16);
+    b = hash_read<U64>(current + remaining - 8);
+  }
+
+  a ^= HASH_SECRET[1];
+  b ^= seed;
+
+  detail::multiply_128(a, b, &a, &b);
+
+  return hash_mix(a ^ HASH_SECRET[0] ^ length, b ^ HASH_SECRET[1]);
+}
+
+// The key of a keyed hash.
+struct HashKey {
+  U64 first;
+  U64 second;
+};
+
+namespace detail {
+
+constexpr void sip_round(U64& v0, U64& v1, U64& v2, U64& v3) {
+  v0 += v1;
+  v1 = std::rotl(v1, 13);
+  v1 ^= v0;
+  v0 = std::rotl(v0, 32);
+  v2 += v3;
+  v3 = std::rotl(v3, 16);
+  v3 ^= v2;
+  v0 += v3;
+  v3 = std::rotl(v3, 21);
+  v3 ^= v0;
+  v2 += v1;
+  v1 = std::rotl(v1, 17);
+  v1 ^= v2;
+  v2 = std::rotl(v2, 32);
+}
+
+template <I32 CompressionRounds, I32 FinalizationRounds>
+constexpr U64 sip_hash(const char* data, MemSize length, const HashKey& key) {
+  U64 v0 = key.first ^ 0x736f6d6570736575ull;
+  U64 v1 = key.second ^ 0x646f72616e646f6dull;
+  U64 v2 = key.first ^ 0x6c7967656e657261ull;
+  U64 v3 = key.second ^ 0x7465646279746573ull;
+
+  auto compress = [&](U64 word) {
+    v3 ^= word;
+    for (I32 i = 0; i < CompressionRounds; ++i) {
+      sip_round(v0, v1, v2, v3);
+    }
+    v0 ^= word;
+  };
+
+  MemSize full_words_end = length & ~static_cast<MemSize>(7);
+  for (MemSize offset = 0; offset < full_words_end; offset += 8) {
+    compress(hash_read<U64>(data + offset));
+  }
+
+  // The last word holds the remaining bytes and the low byte of the length.
+  U64 last = static_cast<U64>(length) << 56;
+  for (MemSize i = full_words_end; i < length; ++i) {
+    last |= static_cast<U64>(static_cast<U8>(data[i])) << ((i - full_words_end) * 8);
+  }
+  compress(last);
+
+  v2 ^= 0xFF;
+  for (I32 i = 0; i < FinalizationRounds; ++i) {
+    sip_round(v0, v1, v2, v3);
+  }
+
+  return v0 ^ v1 ^ v2 ^ v3;
+}
+
+}  // namespace detail
+
+// Hashes `length` bytes with SipHash-1-3.  Unlike `hash_bytes`, it is not feasible to find inputs
+// with colliding hashes without knowing `key`, so it is safe to use on keys chosen by someone else.
+// It is a few times slower than `hash_bytes`.
+constexpr U64 keyed_hash_bytes(const char* data, MemSize length, const HashKey& key) {
+  return detail::sip_hash<1, 3>(data, length, key);
+}
+
+// A random key picked the first time it is used and then kept for the lifetime of the process.
+const HashKey& process_hash_key();
+
 template <typename T>
 struct Hash;
 
+// Same as `Hash`, but keyed with `process_hash_key`, so the hashes of keys can not be predicted
+// from outside of the process.  Use it for hash tables keyed by data that comes from clients, e.g.
+// `HashMap<DynamicString, V, GroupProbing, SeededHash>`, so they can not be flooded with keys that
+// all collide.
+template <typename T>
+struct SeededHash;
+
+// Hash containers can look up items with a type other than their key type if equal values of both
+// types have the same hash and compare equal with `==`, e.g. `DynamicString` keys with a
+// `StringView`.  Specialize this for a pair of types to allow it.
+template <typename KeyType, typename LookupType>
+struct IsHashCompatible {
+  static constexpr bool value = false;
+};
+
+template <typename KeyType, typename LookupType>
+using EnableIfHashCompatible = std::enable_if_t<IsHashCompatible<KeyType, LookupType>::value>;
+
 template <>
 struct Hash<I32> {
   static HashedValue hashed(I32 value) {
@@ -70,4 +294,45 @@ struct Hash<U64> {
   }
 };
 
+namespace detail {
+
+template <typename T>
+inline HashedValue seeded_hash_integer(T value) {
+  static_assert(std::is_integral_v<T>);
+
+  char bytes[sizeof(T)];
+  std::memcpy(bytes, &value, sizeof(T));
+  return static_cast<HashedValue>(keyed_hash_bytes(bytes, sizeof(T), process_hash_key()));
+}
+
+}  // namespace detail
+
+template <>
+struct SeededHash<I32> {
+  static HashedValue hashed(I32 value) {
+    return detail::seeded_hash_integer(value);
+  }
+};
+
+template <>
+struct SeededHash<U32> {
+  static HashedValue hashed(U32 value) {
+    return detail::seeded_hash_integer(value);
+  }
+};
+
+template <>
+struct SeededHash<I64> {
+  static HashedValue hashed(I64 value) {
+    return detail::seeded_hash_integer(value);
+  }
+};
+
+template <>
+struct SeededHash<U64> {
+  static HashedValue hashed(U64 value) {
+    return detail::seeded_hash_integer(value);
+  }
+};
+
 }  // namespace nu
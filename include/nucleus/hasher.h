@@ -0,0 +1,69 @@
+#pragma once
+
+#include "nucleus/containers/array_view.h"
+#include "nucleus/types.h"
+
+namespace nu {
+
+namespace detail {
+
+// The table driven CRC-32C, used when the CPU does not have SSE4.2.  `crc` is the running CRC
+// register, not the finished checksum.
+U32 crc32c_software(U32 crc, const U8* data, MemSize size);
+
+}  // namespace detail
+
+// Hashes data that arrives in pieces, e.g. to checksum a file while it is being read.  Feeding the
+// same bytes through any number of `update` calls gives the same result as a single call.
+class Hasher {
+public:
+  enum class Algorithm : U8 {
+    // XXH64, a fast 64-bit non-cryptographic hash.
+    XXH64,
+    // CRC-32C (Castagnoli), as used by iSCSI, ext4 and many file formats.  Uses the SSE4.2 `crc32`
+    // instruction when the CPU has it, and a slicing-by-8 table lookup otherwise.
+    CRC32C,
+  };
+
+  // For CRC-32C, `seed` is the CRC of any data that came before, so a checksum can be continued.
+  explicit Hasher(Algorithm algorithm, U64 seed = 0);
+
+  Algorithm algorithm() const {
+    return algorithm_;
+  }
+
+  // Start over, as if nothing was hashed yet.
+  void reset();
+
+  void update(const void* data, MemSize size);
+
+  void update(ArrayView<U8> data) {
+    update(data.data(), data.size());
+  }
+
+  // The hash of everything passed to `update` so far.  CRC-32C results are 32 bits wide.  More
+  // data can still be added afterwards.
+  U64 finish() const;
+
+  // True if CRC-32C runs on the SSE4.2 `crc32` instruction.
+  static bool has_hardware_crc32c();
+
+private:
+  void update_xxh64(const U8* data, MemSize size);
+  U64 finish_xxh64() const;
+
+  Algorithm algorithm_;
+  U64 seed_;
+
+  // Total number of bytes hashed.
+  U64 length_ = 0;
+
+  // XXH64 keeps four accumulators and buffers input until it has a full 32-byte stripe.  CRC-32C
+  // only uses `crc_`.
+  U64 accumulators_[4] = {};
+  U8 buffer_[32] = {};
+  MemSize buffered_ = 0;
+  U32 crc_ = 0;
+};
+
+}  // namespace nu
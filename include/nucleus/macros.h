@@ -33,6 +33,24 @@
 #error Unknown compiler.
 #endif
 
+// NO_UNIQUE_ADDRESS
+
+// Lets members without state, like most allocators, take up no space in the object.
+#if COMPILER(GCC)
+#define NU_NO_UNIQUE_ADDRESS [[no_unique_address]]
+#elif COMPILER(MSVC)
+#define NU_NO_UNIQUE_ADDRESS [[msvc::no_unique_address]]
+#endif
+
+// PREFETCH
+
+#if COMPILER(GCC)
+#define NU_PREFETCH(Address) __builtin_prefetch(Address)
+#elif COMPILER(MSVC)
+#include <xmmintrin.h>
+#define NU_PREFETCH(Address) _mm_prefetch(reinterpret_cast<const char*>(Address), _MM_HINT_T0)
+#endif
+
 // ARRAY_SIZE
 
 // Helper to figure out the item count of a static array of elements, c++ style!
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <atomic>
+
+#include "nucleus/containers/static_array.h"
+#include "nucleus/text/string_view.h"
+#include "nucleus/types.h"
+
+namespace nu {
+
+// Allocations are counted per tag, to find out which part of a program the memory belongs to.
+// Every container gets a tag of its own through its default allocator, see `MallocAllocator`.
+// Other subsystems use tags from `user_allocation_tag<N>()` with containers like
+// `DynamicArray<T, MallocAllocator<NETWORK_TAG>>`.
+enum class AllocationTag : U8 {
+  General,
+  DynamicArray,
+  DynamicString,
+  HashTable,
+  StablePool,
+  StringPool,
+  Arena,
+
+  FirstUserTag = 16,
+};
+
+constexpr MemSize MAX_ALLOCATION_TAGS = 64;
+
+// The number of tags from `FirstUserTag` up, checked when the tag is made.
+constexpr MemSize MAX_USER_ALLOCATION_TAGS =
+    MAX_ALLOCATION_TAGS - static_cast<MemSize>(AllocationTag::FirstUserTag);
+
+template <U8 Index>
+constexpr AllocationTag user_allocation_tag() {
+  static_assert(Index < MAX_USER_ALLOCATION_TAGS, "User allocation tag out of range.");
+
+  return static_cast<AllocationTag>(static_cast<U8>(AllocationTag::FirstUserTag) + Index);
+}
+
+// `name` must stay valid for as long as the tag is used, e.g. a string literal.
+void set_allocation_tag_name(AllocationTag tag, StringView name);
+
+StringView allocation_tag_name(AllocationTag tag);
+
+// Accounting is off until it is enabled.  Turn it on before the allocations that should be counted
+// are made, because memory that is freed without being counted makes the live bytes go negative.
+void enable_allocation_accounting(bool enabled = true);
+
+namespace detail {
+
+extern std::atomic<bool> allocation_accounting_enabled;
+
+void count_allocation(AllocationTag tag, MemSize size);
+void count_deallocation(AllocationTag tag, MemSize size);
+
+}  // namespace detail
+
+inline bool is_allocation_accounting_enabled() {
+  return detail::allocation_accounting_enabled.load(std::memory_order_relaxed);
+}
+
+// Called by allocators for every block of memory they hand out or take back.  Each thread counts in
+// its own counters, so threads do not contend with each other.
+inline void record_allocation(AllocationTag tag, MemSize size) {
+  if (is_allocation_accounting_enabled()) {
+    detail::count_allocation(tag, size);
+  }
+}
+
+inline void record_deallocation(AllocationTag tag, MemSize size) {
+  if (is_allocation_accounting_enabled()) {
+    detail::count_deallocation(tag, size);
+  }
+}
+
+struct AllocationStats {
+  I64 live_bytes = 0;
+  // The most live bytes seen at once.  Threads report their byte counts in batches, so it can be
+  // off by a few tens of kilobytes for each thread.
+  I64 peak_bytes = 0;
+  U64 allocations = 0;
+  U64 deallocations = 0;
+};
+
+// The stats of every tag.  Counters of other threads are read while they keep running, so a
+// snapshot is a close approximation rather than a single point in time.
+struct AllocationSnapshot {
+  StaticArray<AllocationStats, MAX_ALLOCATION_TAGS> tags;
+
+  const AllocationStats& operator[](AllocationTag tag) const {
+    return tags[static_cast<MemSize>(tag)];
+  }
+};
+
+AllocationSnapshot take_allocation_snapshot();
+
+// Forgets everything counted so far, e.g. between tests.
+void reset_allocation_accounting();
+
+}  // namespace nu
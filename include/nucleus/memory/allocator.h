@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdlib>
+
+#include "nucleus/logging.h"
+#include "nucleus/memory/allocation_accounting.h"
+#include "nucleus/types.h"
+
+#undef free
+
+namespace nu {
+
+// Containers get their memory from an `Allocator` template parameter, so their storage can live in
+// an arena, a pool or anywhere else without changing the container.  An allocator is a copyable
+// type with these members:
+//
+//   void* allocate(MemSize size, MemSize alignment);
+//   void* reallocate(void* memory, MemSize oldSize, MemSize newSize, MemSize alignment);
+//   void deallocate(void* memory, MemSize size);
+//
+// `reallocate` keeps the first `oldSize` bytes and is only called with memory that came from the
+// same allocator.  `deallocate` is never called with `nullptr`.
+//
+// A container keeps its own copy of the allocator and hands it on when it is copied or moved, so
+// an allocator with state is usually a small handle to where the memory really comes from.
+// Allocators without state take up no space in the container.
+
+// Gets memory from `std::malloc` and counts it under `Tag` when allocation accounting is enabled,
+// see `enable_allocation_accounting`.  Each kind of container uses its own tag by default.
+template <AllocationTag Tag>
+class MallocAllocator {
+public:
+  void* allocate(MemSize size, MemSize alignment) {
+    DCHECK(alignment <= alignof(std::max_align_t)) << "Alignment not supported by malloc.";
+
+    void* memory = std::malloc(size);
+    if (memory) {
+      record_allocation(Tag, size);
+    }
+    return memory;
+  }
+
+  void* reallocate(void* memory, MemSize oldSize, MemSize newSize, MemSize alignment) {
+    DCHECK(alignment <= alignof(std::max_align_t)) << "Alignment not supported by malloc.";
+
+    // A failed `realloc` leaves the old block alone, so it stays counted.
+    void* result = std::realloc(memory, newSize);
+    if (result) {
+      record_deallocation(Tag, oldSize);
+      record_allocation(Tag, newSize);
+    }
+    return result;
+  }
+
+  void deallocate(void* memory, MemSize size) {
+    record_deallocation(Tag, size);
+    std::free(memory);
+  }
+};
+
+// For memory that does not belong to a specific kind of container.
+using DefaultAllocator = MallocAllocator<AllocationTag::General>;
+
+}  // namespace nu
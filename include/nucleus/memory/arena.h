@@ -0,0 +1,178 @@
+#pragma once
+
+#include <cstddef>
+#include <new>
+#include <utility>
+
+#include "nucleus/bits.h"
+#include "nucleus/containers/dynamic_array.h"
+#include "nucleus/logging.h"
+#include "nucleus/macros.h"
+#include "nucleus/text/dynamic_string.h"
+#include "nucleus/types.h"
+
+namespace nu {
+
+// Hands out memory by bumping a pointer through large blocks, for many small objects that all die
+// together.  Nothing is freed one object at a time: `reset` makes all of the memory available again
+// at once and a `Scope` gives back everything allocated while it was alive.  Blocks are kept for
+// reuse and only freed when the arena is destroyed.  Each new block is twice the size of the one
+// before it.
+//
+// Objects in the arena are never destroyed, so only put objects there that do not need their
+// destructor to run, or that only own memory in the same arena.
+class Arena {
+  NU_DELETE_COPY_AND_MOVE(Arena);
+
+  struct Block;
+
+  struct Mark {
+    Block* block;
+    MemSize offset;
+  };
+
+public:
+  static constexpr MemSize DEFAULT_BLOCK_SIZE = 4096;
+
+  // Gives back everything allocated from the arena while the scope was alive, so nothing allocated
+  // inside the scope may be used after it ends.
+  class Scope {
+    NU_DELETE_COPY_AND_MOVE(Scope);
+
+  public:
+    explicit Scope(Arena* arena) : arena_{arena}, mark_{arena->mark()} {}
+
+    ~Scope() {
+      arena_->rewind(mark_);
+    }
+
+  private:
+    Arena* arena_;
+    Mark mark_;
+  };
+
+  // No memory is allocated until the first allocation.
+  explicit Arena(MemSize first_block_size = DEFAULT_BLOCK_SIZE);
+
+  ~Arena();
+
+  // Returns `size` bytes aligned to `alignment`, which must be a power of two.
+  void* allocate(MemSize size, MemSize alignment = alignof(std::max_align_t)) {
+    DCHECK(is_power_of_two(alignment)) << "Alignment must be a power of two.";
+
+    if (current_) {
+      MemSize start = aligned_offset(current_, offset_, alignment);
+      if (start + size <= current_->size) {
+        offset_ = start + size;
+        return current_->data() + start;
+      }
+    }
+
+    return allocate_slow(size, alignment);
+  }
+
+  // Grows the allocation in place if it is the last one made from the arena and there is space
+  // after it, otherwise copies it to new memory.
+  void* reallocate(void* memory, MemSize old_size, MemSize new_size, MemSize alignment);
+
+  // Gives the memory back if it is the last allocation made from the arena, otherwise the memory
+  // stays in use until the arena is reset.
+  void deallocate(void* memory, MemSize size);
+
+  template <typename T, typename... Args>
+  T* construct(Args&&... args) {
+    return new (allocate(sizeof(T), alignof(T))) T{std::forward<Args>(args)...};
+  }
+
+  // Makes all the memory available again without freeing any of it.
+  void reset();
+
+  // Number of bytes up to the current position in the arena, including padding for alignment and
+  // the unused ends of earlier blocks.
+  NU_NO_DISCARD MemSize bytes_used() const;
+
+  // Number of bytes in all the blocks owned by the arena.
+  NU_NO_DISCARD MemSize bytes_reserved() const;
+
+private:
+  // The bytes of the block follow right after this header.
+  struct Block {
+    Block* next;
+    MemSize size;
+
+    U8* data() {
+      return reinterpret_cast<U8*>(this + 1);
+    }
+  };
+
+  // The first offset from `offset` onwards where memory in `block` is aligned to `alignment`.
+  static MemSize aligned_offset(Block* block, MemSize offset, MemSize alignment) {
+    auto address = reinterpret_cast<MemSize>(block->data()) + offset;
+    return offset + (((address + alignment - 1) & ~(alignment - 1)) - address);
+  }
+
+  Mark mark() const {
+    return {current_, offset_};
+  }
+
+  void rewind(const Mark& mark) {
+    current_ = mark.block;
+    offset_ = mark.offset;
+  }
+
+  // True if `memory` is the last allocation made from the arena.
+  bool is_last(void* memory, MemSize size) const {
+    return current_ && static_cast<U8*>(memory) + size == current_->data() + offset_;
+  }
+
+  NU_NEVER_INLINE void* allocate_slow(MemSize size, MemSize alignment);
+
+  MemSize first_block_size_;
+  // All the blocks, in the order they are used.
+  Block* first_ = nullptr;
+  // The block allocations are made from, or `nullptr` if nothing is allocated.
+  Block* current_ = nullptr;
+  // Offset of the first free byte in `current_`.
+  MemSize offset_ = 0;
+};
+
+// Lets containers keep their storage in an `Arena`.  The arena has to outlive the containers.
+class ArenaAllocator {
+public:
+  explicit ArenaAllocator(Arena* arena) : arena_{arena} {}
+
+  void* allocate(MemSize size, MemSize alignment) {
+    return arena_->allocate(size, alignment);
+  }
+
+  void* reallocate(void* memory, MemSize old_size, MemSize new_size, MemSize alignment) {
+    return arena_->reallocate(memory, old_size, new_size, alignment);
+  }
+
+  void deallocate(void* memory, MemSize size) {
+    arena_->deallocate(memory, size);
+  }
+
+  NU_NO_DISCARD Arena* arena() const {
+    return arena_;
+  }
+
+private:
+  Arena* arena_;
+};
+
+template <typename T>
+using ArenaArray = DynamicArray<T, ArenaAllocator>;
+
+using ArenaString = BasicDynamicString<ArenaAllocator>;
+
+template <typename T>
+ArenaArray<T> make_arena_array(Arena* arena, MemSize initial_capacity = 0) {
+  return ArenaArray<T>::withInitialCapacity(initial_capacity, ArenaAllocator{arena});
+}
+
+inline ArenaString make_arena_string(Arena* arena, StringView text = {}) {
+  return ArenaString{text, ArenaAllocator{arena}};
+}
+
+}  // namespace nu
@@ -2,7 +2,7 @@
 
 #include <mutex>
 
-#include "nucleus/containers/dynamic_array.h"
+#include "nucleus/containers/inline_dynamic_array.h"
 #include "nucleus/memory/scoped_ptr.h"
 #include "nucleus/function.h"
 #include "nucleus/macros.h"
@@ -29,6 +29,10 @@ public:
   // Continue executing tasks until a quit task is posted to the queue.
   void run();
 
+  // Called each time the loop finds its task queue empty.  No task is running at that point, which
+  // makes it a good place for quiescent calls, see `EpochDomain`.
+  void set_idle_callback(Function<void()> callback);
+
 private:
   // Override: MessageLoopDelegate
   bool progress() override;
@@ -37,9 +41,10 @@ private:
 
   MessagePump* pump_;
   bool quit_on_idle_ = false;
+  Function<void()> idle_callback_;
 
   std::mutex incoming_tasks_lock_;
-  DynamicArray<Function<void()>> incoming_tasks_;
+  InlineDynamicArray<Function<void()>> incoming_tasks_;
 };
 
 }  // namespace nu
@@ -1,6 +1,8 @@
 #pragma once
 
 #include "nucleus/containers/dynamic_array.h"
+#include "nucleus/containers/inline_dynamic_array.h"
+#include "nucleus/memory/arena.h"
 #include "nucleus/text/string_view.h"
 
 namespace nu {
@@ -10,16 +12,40 @@ struct XMLAttribute {
   StringView value;
 };
 
-struct XMLNode {
+// Most nodes have only a handful of attributes, so they are stored inside the node.
+template <typename Allocator>
+using BasicXMLAttributes = InlineDynamicArray<XMLAttribute, 4, Allocator>;
+
+// The attributes and children of every node are allocated from `Allocator`, so a whole tree can be
+// built inside an `Arena`, see `ArenaXMLDocument`.  Names and values point into the source text.
+template <typename Allocator = DefaultAllocator>
+struct BasicXMLNode {
+  explicit BasicXMLNode(const Allocator& allocator = Allocator{})
+    : attributes{allocator}, children{allocator} {}
+
   StringView name;
-  DynamicArray<XMLAttribute> attributes;
-  DynamicArray<XMLNode> children;
+  BasicXMLAttributes<Allocator> attributes;
+  DynamicArray<BasicXMLNode, Allocator> children;
 };
 
-struct XMLDocument {
-  XMLNode rootNode;
+template <typename Allocator = DefaultAllocator>
+struct BasicXMLDocument {
+  explicit BasicXMLDocument(const Allocator& allocator = Allocator{}) : rootNode{allocator} {}
+
+  BasicXMLNode<Allocator> rootNode;
 };
 
+using XMLAttributes = BasicXMLAttributes<DefaultAllocator>;
+using XMLNode = BasicXMLNode<DefaultAllocator>;
+using XMLDocument = BasicXMLDocument<DefaultAllocator>;
+
+using ArenaXMLNode = BasicXMLNode<ArenaAllocator>;
+using ArenaXMLDocument = BasicXMLDocument<ArenaAllocator>;
+
 XMLDocument parseXMLDocument(const StringView& source);
 
+// Same as above, but the whole tree is allocated from `arena`, so it is thrown away in one go with
+// the arena.
+ArenaXMLDocument parseXMLDocument(const StringView& source, Arena* arena);
+
 }  // namespace nu
@@ -1,7 +1,9 @@
 #pragma once
 
 #include "nucleus/containers/dynamic_array.h"
+#include "nucleus/containers/hash_map.h"
 #include "nucleus/memory/scoped_ptr.h"
+#include "nucleus/text/dynamic_string.h"
 #include "nucleus/text/static_string.h"
 #include "nucleus/text/string_view.h"
 
@@ -44,11 +46,20 @@ public:
     return &m_root;
   }
 
+  // Counters hold the last value that was set for each name, e.g. sampled statistics of a
+  // container.
+  auto setCounter(StringView name, F64 value) -> void;
+
+  auto counters() const -> const HashMap<DynamicString, F64>& {
+    return m_counters;
+  }
+
 private:
   Block m_root;
   Block* m_current;
 
   DynamicArray<Block*> m_blocks;
+  HashMap<DynamicString, F64> m_counters;
 };
 
 ProfileMetrics* getCurrentProfileMetrics();
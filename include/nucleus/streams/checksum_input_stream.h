@@ -0,0 +1,36 @@
+#pragma once
+
+#include "nucleus/hasher.h"
+#include "nucleus/streams/input_stream.h"
+
+namespace nu {
+
+// Reads from another stream and feeds every byte that passes through into a `Hasher`, so data can
+// be verified while it is loaded instead of in a second pass.
+class ChecksumInputStream : public InputStream {
+  NU_DELETE_COPY_AND_MOVE(ChecksumInputStream);
+
+public:
+  // Neither the source stream nor the hasher are owned and both have to outlive this stream.
+  ChecksumInputStream(InputStream* source, Hasher* hasher);
+  ~ChecksumInputStream() override;
+
+  Hasher* hasher() const {
+    return m_hasher;
+  }
+
+  // Override: InputStream
+  SizeType getPosition() override;
+  // Only moving forward is allowed, and the bytes that are skipped are still hashed.  Moving
+  // backwards fails, because those bytes were hashed already.
+  bool setPosition(SizeType newPosition) override;
+  SizeType getSize() override;
+  bool isExhausted() override;
+  SizeType read(void* destination, SizeType bytesToRead) override;
+
+private:
+  InputStream* m_source;
+  Hasher* m_hasher;
+};
+
+}  // namespace nu
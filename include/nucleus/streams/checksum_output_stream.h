@@ -0,0 +1,29 @@
+#pragma once
+
+#include "nucleus/hasher.h"
+#include "nucleus/streams/output_stream.h"
+#include "nucleus/macros.h"
+
+namespace nu {
+
+// Writes to another stream and feeds every byte that was written into a `Hasher`, so a checksum
+// can be stored along with the data without going over it again.
+class ChecksumOutputStream : public OutputStream {
+  NU_DELETE_COPY_AND_MOVE(ChecksumOutputStream);
+
+public:
+  // Neither the destination stream nor the hasher are owned and both have to outlive this stream.
+  ChecksumOutputStream(OutputStream* destination, Hasher* hasher);
+
+  Hasher* hasher() const {
+    return m_hasher;
+  }
+
+  SizeType write(const void* buffer, SizeType size) override;
+
+private:
+  OutputStream* m_destination;
+  Hasher* m_hasher;
+};
+
+}  // namespace nu
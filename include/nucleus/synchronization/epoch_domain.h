@@ -0,0 +1,84 @@
+#pragma once
+
+#include <atomic>
+
+#include "nucleus/containers/dynamic_array.h"
+#include "nucleus/macros.h"
+#include "nucleus/synchronization/lock.h"
+#include "nucleus/types.h"
+
+namespace nu {
+
+// Decides when memory that lock-free readers might still be looking at can be deleted.
+//
+// Readers do not announce when they start or stop reading, so reads cost nothing extra.  Instead
+// every reading thread registers a `Participant` and calls `quiescent()` at points where it holds
+// no references to shared data, e.g. from the idle callback of its `MessageLoop`.  Writers publish
+// a new version of their data and `retire` the old one, which is deleted once every participant
+// passed a quiescent point after it was retired.
+class EpochDomain {
+  NU_DELETE_COPY_AND_MOVE(EpochDomain);
+
+public:
+  class Participant {
+    NU_DELETE_COPY_AND_MOVE(Participant);
+
+  public:
+    explicit Participant(EpochDomain* domain);
+    ~Participant();
+
+    // Declare that the calling thread holds no references to data protected by the domain.
+    void quiescent();
+
+  private:
+    friend class EpochDomain;
+
+    EpochDomain* domain_;
+
+    // The global epoch at the last quiescent point.  Only written by the thread owning the
+    // participant and kept on its own cache line, so quiescent calls do not slow down other
+    // threads.
+    alignas(CACHE_LINE_SIZE) std::atomic<U64> epoch_;
+  };
+
+  using Deleter = void (*)(void*);
+
+  EpochDomain();
+
+  // Deletes everything that is still retired, so no participants may be left.
+  ~EpochDomain();
+
+  // Hand over an object that readers might still be using.  `deleter(object)` is called once all
+  // participants are done with it.
+  void retire(void* object, Deleter deleter);
+
+  template <typename T>
+  void retire(T* object) {
+    retire(object, [](void* o) {
+      delete static_cast<T*>(o);
+    });
+  }
+
+  // Delete all retired objects that no participant can be using any more.  Called on every
+  // `retire`, but also useful after participants went through quiescent points.
+  void collect();
+
+  // Number of retired objects that are not deleted yet.
+  NU_NO_DISCARD MemSize pending() const;
+
+private:
+  struct Retired {
+    // The object is safe to delete once all participants saw an epoch after this one.
+    U64 epoch;
+    void* object;
+    Deleter deleter;
+  };
+
+  std::atomic<U64> global_epoch_{0};
+
+  mutable Lock lock_;
+  DynamicArray<Participant*> participants_;
+  DynamicArray<Retired> retired_;
+};
+
+}  // namespace nu
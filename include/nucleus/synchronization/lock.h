@@ -27,6 +27,8 @@ public:
 
 private:
   NU_DELETE_COPY_AND_MOVE(Lock);
+
+  NativeHandle handle_;
 };
 
 }  // namespace nu
@@ -0,0 +1,60 @@
+#pragma once
+
+#include "nucleus/logging.h"
+#include "nucleus/macros.h"
+#include "nucleus/memory/allocator.h"
+#include "nucleus/types.h"
+
+namespace nu {
+
+namespace testing {
+
+struct AllocationCounts {
+  I32 allocations = 0;
+  I32 deallocations = 0;
+  MemSize bytesInUse = 0;
+};
+
+// An allocator with state that records what goes through it in `AllocationCounts` owned by the
+// test, to check that a container gets all its memory from its allocator and gives it all back.
+class CountingAllocator {
+public:
+  explicit CountingAllocator(AllocationCounts* counts) : counts_{counts} {}
+
+  void* allocate(MemSize size, MemSize alignment) {
+    counts_->allocations += 1;
+    counts_->bytesInUse += size;
+
+    return DefaultAllocator{}.allocate(size, alignment);
+  }
+
+  void* reallocate(void* memory, MemSize oldSize, MemSize newSize, MemSize alignment) {
+    DCHECK(counts_->bytesInUse >= oldSize);
+
+    counts_->allocations += 1;
+    counts_->deallocations += 1;
+    counts_->bytesInUse += newSize - oldSize;
+
+    return DefaultAllocator{}.reallocate(memory, oldSize, newSize, alignment);
+  }
+
+  void deallocate(void* memory, MemSize size) {
+    DCHECK(counts_->bytesInUse >= size);
+
+    counts_->deallocations += 1;
+    counts_->bytesInUse -= size;
+
+    DefaultAllocator{}.deallocate(memory, size);
+  }
+
+  NU_NO_DISCARD AllocationCounts* counts() const {
+    return counts_;
+  }
+
+private:
+  AllocationCounts* counts_;
+};
+
+}  // namespace testing
+
+}  // namespace nu
@@ -1,9 +1,14 @@
 #pragma once
 
+#include <algorithm>
+#include <cstring>
+
 #include "nucleus/text/char_traits.h"
 #include "nucleus/text/string_view.h"
 #include "nucleus/hash.h"
 #include "nucleus/logging.h"
+#include "nucleus/macros.h"
+#include "nucleus/memory/allocator.h"
 
 #undef min
 #undef max
@@ -11,42 +16,59 @@
 
 namespace nu {
 
-class DynamicString {
+// The characters are stored in memory from `Allocator`, see `MallocAllocator`.  Use
+// `DynamicString` unless the memory has to come from somewhere else.
+template <typename Allocator>
+class BasicDynamicString {
 public:
-  constexpr DynamicString() = default;
+  constexpr BasicDynamicString() = default;
+
+  explicit BasicDynamicString(const Allocator& allocator) : m_allocator{allocator} {}
 
-  DynamicString(StringView text) {
+  BasicDynamicString(StringView text, const Allocator& allocator = Allocator{})
+    : m_allocator{allocator} {
     ensureAllocated(text.length(), false);
     std::memcpy(m_data, text.data(), text.length());
     m_length = text.length();
   }
 
-  DynamicString(const DynamicString& other) {
+  BasicDynamicString(const BasicDynamicString& other) : m_allocator{other.m_allocator} {
     ensureAllocated(other.length(), false);
     std::memcpy(m_data, other.data(), other.length());
     m_length = other.length();
   }
 
-  DynamicString(DynamicString&& other)
-    : m_data{other.m_data}, m_length{other.m_length}, m_capacity{other.m_capacity} {
+  BasicDynamicString(BasicDynamicString&& other)
+    : m_data{other.m_data},
+      m_length{other.m_length},
+      m_capacity{other.m_capacity},
+      m_allocator{std::move(other.m_allocator)} {
     other.m_data = nullptr;
     other.m_length = 0;
     other.m_capacity = 0;
   }
 
-  ~DynamicString() {
+  ~BasicDynamicString() {
     free();
   }
 
-  friend bool operator==(const DynamicString& left, const DynamicString& right) {
+  friend bool operator==(const BasicDynamicString& left, const BasicDynamicString& right) {
     return left.view() == right.view();
   }
 
-  friend bool operator!=(const DynamicString& left, const DynamicString& right) {
+  friend bool operator!=(const BasicDynamicString& left, const BasicDynamicString& right) {
     return left.view() != right.view();
   }
 
-  DynamicString& operator=(const DynamicString& other) {
+  friend bool operator==(const BasicDynamicString& left, const StringView& right) {
+    return left.view() == right;
+  }
+
+  friend bool operator!=(const BasicDynamicString& left, const StringView& right) {
+    return left.view() != right;
+  }
+
+  BasicDynamicString& operator=(const BasicDynamicString& other) {
     ensureAllocated(other.m_length, false);
     std::memcpy(m_data, other.m_data, other.m_length);
     m_length = other.m_length;
@@ -54,10 +76,17 @@ public:
     return *this;
   }
 
-  DynamicString& operator=(DynamicString&& other) {
+  BasicDynamicString& operator=(BasicDynamicString&& other) {
+    if (this == &other) {
+      return *this;
+    }
+
+    free();
+
     m_data = other.m_data;
     m_length = other.m_length;
     m_capacity = other.m_capacity;
+    m_allocator = std::move(other.m_allocator);
     other.m_data = nullptr;
     other.m_length = 0;
     other.m_capacity = 0;
@@ -65,7 +94,7 @@ public:
     return *this;
   }
 
-  DynamicString& operator=(StringView text) {
+  BasicDynamicString& operator=(StringView text) {
     ensureAllocated(text.length(), false);
     std::memcpy(m_data, text.data(), text.length());
     m_length = text.length();
@@ -107,6 +136,10 @@ public:
     return {m_data, m_length};
   }
 
+  const Allocator& allocator() const {
+    return m_allocator;
+  }
+
   void append(Char ch) {
     ensureAllocated(m_length + 1, true);
     m_data[m_length++] = ch;
@@ -147,34 +180,84 @@ public:
   }
 
 private:
-  auto ensureAllocated(MemSize sizeRequired, bool keepOld) -> void;
-  auto free() -> void;
+  auto ensureAllocated(MemSize sizeRequired, bool keepOld) -> void {
+    if (sizeRequired <= m_capacity) {
+      return;
+    }
+
+    // Minimum of 16 bytes.
+    MemSize bytesToAllocate = std::max<MemSize>(m_capacity, 16);
+    while (bytesToAllocate < sizeRequired) {
+      bytesToAllocate *= 2;
+    }
+
+    DCHECK(bytesToAllocate != 0);
+    DCHECK((bytesToAllocate & (bytesToAllocate - 1)) == 0)
+        << "We only work with power of 2 numbers.";
+
+    Char* newText = static_cast<Char*>(m_allocator.allocate(bytesToAllocate, alignof(Char)));
+
+    if (m_data) {
+      if (keepOld) {
+        std::memcpy(newText, m_data, m_length);
+      }
+
+      free();
+    }
+
+    m_data = newText;
+    m_capacity = bytesToAllocate;
+  }
+
+  auto free() -> void {
+    if (m_data) {
+      m_allocator.deallocate(m_data, m_capacity);
+      m_data = nullptr;
+      m_capacity = 0;
+    }
+  }
 
   Char* m_data = nullptr;
   StringLength m_length = 0;
   MemSize m_capacity = 0;
+  NU_NO_UNIQUE_ADDRESS Allocator m_allocator;
 };
 
-inline std::ostream& operator<<(std::ostream& os, const DynamicString& value) {
+using DynamicString = BasicDynamicString<MallocAllocator<AllocationTag::DynamicString>>;
+
+template <typename Allocator>
+std::ostream& operator<<(std::ostream& os, const BasicDynamicString<Allocator>& value) {
   os.rdbuf()->sputn(value.data(), value.length());
   return os;
 }
 
-template <>
-struct Hash<DynamicString> {
-  static HashedValue hashed(const DynamicString& value) {
+template <typename Allocator>
+struct Hash<BasicDynamicString<Allocator>> {
+  static HashedValue hashed(const BasicDynamicString<Allocator>& value) {
     return Hash<decltype(value.view())>::hashed(value.view());
   }
 };
 
+template <typename Allocator>
+struct SeededHash<BasicDynamicString<Allocator>> {
+  static HashedValue hashed(const BasicDynamicString<Allocator>& value) {
+    return SeededHash<StringView>::hashed(value.view());
+  }
+};
+
+template <typename Allocator>
+struct IsHashCompatible<BasicDynamicString<Allocator>, StringView> {
+  static constexpr bool value = true;
+};
+
 }  // namespace nu
 
 namespace std {
 
-template <>
-struct hash<nu::DynamicString> {
-  std::size_t operator()(const nu::DynamicString& s) const noexcept {
-    return nu::Hash<nu::DynamicString>::hashed(s);
+template <typename Allocator>
+struct hash<nu::BasicDynamicString<Allocator>> {
+  std::size_t operator()(const nu::BasicDynamicString<Allocator>& s) const noexcept {
+    return nu::Hash<nu::BasicDynamicString<Allocator>>::hashed(s);
   }
 };
 
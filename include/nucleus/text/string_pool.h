@@ -1,10 +1,13 @@
 #pragma once
 
 #include <cstring>
+#include <new>
 
 #include "nucleus/text/string_view.h"
 #include "nucleus/config.h"
 #include "nucleus/logging.h"
+#include "nucleus/macros.h"
+#include "nucleus/memory/allocator.h"
 #include "nucleus/types.h"
 
 namespace nu {
@@ -22,7 +25,15 @@ public:
   StringPool() = default;
   StringPool(const StringPool&) = delete;
   StringPool(StringPool&&) = delete;
-  ~StringPool() {}
+  ~StringPool() {
+    Block* block = m_first;
+    while (block) {
+      Block* next = block->next;
+      block->~Block();
+      m_allocator.deallocate(block, sizeof(Block));
+      block = next;
+    }
+  }
 
   StringPool& operator=(const StringPool&) = delete;
   StringPool& operator=(StringPool&&) = delete;
@@ -81,9 +92,10 @@ private:
 
   Block* allocateBlock() {
     ++m_blockCount;
-    return new Block{};
+    return new (m_allocator.allocate(sizeof(Block), alignof(Block))) Block{};
   }
 
+  NU_NO_UNIQUE_ADDRESS MallocAllocator<AllocationTag::StringPool> m_allocator;
   MemSize m_blockCount = 0;
   Block* m_first = nullptr;
   Block* m_last = nullptr;
@@ -39,7 +39,7 @@ public:
 
   // Capacity
 
-  const Char* data() const noexcept {
+  constexpr const Char* data() const noexcept {
     return m_text;
   }
 
@@ -176,12 +176,16 @@ inline std::ostream& operator<<(std::ostream& os, const StringView& value) {
 
 template <>
 struct Hash<StringView> {
+  static constexpr HashedValue hashed(const StringView& value) {
+    return static_cast<HashedValue>(hash_bytes(value.data(), value.length()));
+  }
+};
+
+template <>
+struct SeededHash<StringView> {
   static HashedValue hashed(const StringView& value) {
-    HashedValue hash = 7;
-    for (StringLength i = 0; i < value.length(); ++i) {
-      hash = hash * 31 + value[i];
-    }
-    return hash;
+    return static_cast<HashedValue>(
+        keyed_hash_bytes(value.data(), value.length(), process_hash_key()));
   }
 };
 
@@ -0,0 +1,243 @@
+#pragma once
+
+#include <algorithm>
+#include <functional>
+#include <mutex>
+
+#include "nucleus/containers/array_view.h"
+#include "nucleus/containers/dynamic_array.h"
+#include "nucleus/threading/worker_pool.h"
+
+namespace nu {
+
+// Algorithms that split their work over the threads of `WorkerPool::shared`.  Inputs with no more
+// than `PARALLEL_GRAIN_SIZE` elements are handled on the calling thread, as is any work that is
+// started from one of the workers.  Threads never take fewer elements than that at a time, so
+// handing out the work costs little compared to doing it.
+constexpr MemSize PARALLEL_GRAIN_SIZE = 2048;
+
+namespace detail {
+
+// Calls `func(begin, end)` for ranges that together cover `[0, count)`, without creating the
+// shared pool when the work is too small to share.
+template <typename Func>
+void parallel_ranges(MemSize count, MemSize min_range, Func& func) {
+  if (count <= min_range) {
+    if (count > 0) {
+      func(MemSize{0}, count);
+    }
+    return;
+  }
+
+  WorkerPool::shared().run(count, min_range, func);
+}
+
+// The number of pieces to split `size` elements into so that each thread gets a few, but no piece
+// is smaller than the grain size.  Always a power of two.
+inline MemSize parallel_piece_count(MemSize size) {
+  MemSize threads = WorkerPool::shared().worker_count() + 1;
+  if (threads == 1) {
+    return 1;
+  }
+
+  MemSize result = 1;
+  while (result < threads * 2 && size / (result * 2) >= PARALLEL_GRAIN_SIZE) {
+    result *= 2;
+  }
+  return result;
+}
+
+inline MemSize parallel_piece_start(MemSize size, MemSize piece_count, MemSize piece) {
+  return size * piece / piece_count;
+}
+
+}  // namespace detail
+
+// Calls `func(index)` for every index in `[0, count)`.
+template <typename Func>
+void parallel_for(MemSize count, Func func) {
+  auto range = [&func](MemSize begin, MemSize end) {
+    for (MemSize i = begin; i < end; ++i) {
+      func(i);
+    }
+  };
+  detail::parallel_ranges(count, PARALLEL_GRAIN_SIZE, range);
+}
+
+// Calls `func(item)` for every item.
+template <typename T, typename Func>
+void parallel_for(ArrayView<T> items, Func func) {
+  const T* data = items.data();
+  auto range = [data, &func](MemSize begin, MemSize end) {
+    for (MemSize i = begin; i < end; ++i) {
+      func(data[i]);
+    }
+  };
+  detail::parallel_ranges(items.size(), PARALLEL_GRAIN_SIZE, range);
+}
+
+// Calls `func(item)` for every item, with a reference that can be changed.
+template <typename T, typename Allocator, typename Func>
+void parallel_for(DynamicArray<T, Allocator>* items, Func func) {
+  T* data = items->data();
+  auto range = [data, &func](MemSize begin, MemSize end) {
+    for (MemSize i = begin; i < end; ++i) {
+      func(data[i]);
+    }
+  };
+  detail::parallel_ranges(items->size(), PARALLEL_GRAIN_SIZE, range);
+}
+
+// Combines all the items with `reduce(T, const T&)`, starting from `identity`.  `reduce` must be
+// associative, but items are always combined in order, so it does not have to be commutative.
+template <typename T, typename Reduce>
+T parallel_reduce(ArrayView<T> items, T identity, Reduce reduce) {
+  const T* data = items.data();
+
+  if (items.size() <= PARALLEL_GRAIN_SIZE) {
+    for (MemSize i = 0; i < items.size(); ++i) {
+      identity = reduce(std::move(identity), data[i]);
+    }
+    return identity;
+  }
+
+  struct Partial {
+    MemSize begin;
+    T value;
+  };
+
+  std::mutex partials_lock;
+  DynamicArray<Partial> partials;
+
+  auto range = [&](MemSize begin, MemSize end) {
+    T value = data[begin];
+    for (MemSize i = begin + 1; i < end; ++i) {
+      value = reduce(std::move(value), data[i]);
+    }
+
+    std::lock_guard<std::mutex> locker{partials_lock};
+    partials.pushBack(Partial{begin, std::move(value)});
+  };
+  detail::parallel_ranges(items.size(), PARALLEL_GRAIN_SIZE, range);
+
+  std::sort(partials.begin(), partials.end(), [](const Partial& left, const Partial& right) {
+    return left.begin < right.begin;
+  });
+
+  for (const Partial& partial : partials) {
+    identity = reduce(std::move(identity), partial.value);
+  }
+  return identity;
+}
+
+// Replaces the contents of `output` with `func(item)` for every item.  `Out` must be default
+// constructible.
+template <typename In, typename Out, typename Allocator, typename Func>
+void parallel_transform(ArrayView<In> input, DynamicArray<Out, Allocator>* output, Func func) {
+  output->resize(input.size());
+
+  const In* source = input.data();
+  Out* destination = output->data();
+  auto range = [source, destination, &func](MemSize begin, MemSize end) {
+    for (MemSize i = begin; i < end; ++i) {
+      destination[i] = func(source[i]);
+    }
+  };
+  detail::parallel_ranges(input.size(), PARALLEL_GRAIN_SIZE, range);
+}
+
+// Sorts the items with `less`.  The sort is not stable.  Pieces of the array are sorted at the
+// same time and then merged in pairs, so the last merge runs on a single thread.
+template <typename T, typename Allocator, typename Less = std::less<T>>
+void parallel_sort(DynamicArray<T, Allocator>* items, Less less = Less{}) {
+  MemSize size = items->size();
+  T* data = items->data();
+
+  MemSize piece_count = size > PARALLEL_GRAIN_SIZE ? detail::parallel_piece_count(size) : 1;
+  if (piece_count == 1) {
+    std::sort(data, data + size, less);
+    return;
+  }
+
+  auto start = [size, piece_count](MemSize piece) {
+    return detail::parallel_piece_start(size, piece_count, piece);
+  };
+
+  auto sort_pieces = [&](MemSize begin, MemSize end) {
+    for (MemSize piece = begin; piece < end; ++piece) {
+      std::sort(data + start(piece), data + start(piece + 1), less);
+    }
+  };
+  WorkerPool::shared().run(piece_count, 1, sort_pieces);
+
+  for (MemSize width = 1; width < piece_count; width *= 2) {
+    auto merge_pieces = [&](MemSize begin, MemSize end) {
+      for (MemSize merge = begin; merge < end; ++merge) {
+        MemSize first = merge * width * 2;
+        std::inplace_merge(data + start(first), data + start(first + width),
+                           data + start(first + width * 2), less);
+      }
+    };
+    WorkerPool::shared().run(piece_count / (width * 2), 1, merge_pieces);
+  }
+}
+
+// Replaces the contents of `output` with the inclusive scan of the items, where each element is
+// `op` applied to all the items up to and including it.  `op(const T&, const T&)` must be
+// associative.  `T` must be default constructible.
+template <typename T, typename Allocator, typename Op>
+void parallel_scan(ArrayView<T> input, DynamicArray<T, Allocator>* output, Op op) {
+  MemSize size = input.size();
+  output->resize(size);
+
+  const T* source = input.data();
+  T* destination = output->data();
+
+  auto scan = [source, destination, &op](MemSize begin, MemSize end) {
+    destination[begin] = source[begin];
+    for (MemSize i = begin + 1; i < end; ++i) {
+      destination[i] = op(destination[i - 1], source[i]);
+    }
+  };
+
+  MemSize piece_count = size > PARALLEL_GRAIN_SIZE ? detail::parallel_piece_count(size) : 1;
+  if (piece_count == 1) {
+    if (size > 0) {
+      scan(0, size);
+    }
+    return;
+  }
+
+  auto start = [size, piece_count](MemSize piece) {
+    return detail::parallel_piece_start(size, piece_count, piece);
+  };
+
+  // Scan every piece on its own first.
+  auto scan_pieces = [&](MemSize begin, MemSize end) {
+    for (MemSize piece = begin; piece < end; ++piece) {
+      scan(start(piece), start(piece + 1));
+    }
+  };
+  WorkerPool::shared().run(piece_count, 1, scan_pieces);
+
+  // Then work out what comes before each piece from the last element of the pieces before it...
+  DynamicArray<T> carries;
+  carries.reserve(piece_count - 1);
+  carries.pushBack(destination[start(1) - 1]);
+  for (MemSize piece = 1; piece < piece_count - 1; ++piece) {
+    carries.pushBack(op(carries.last(), destination[start(piece + 1) - 1]));
+  }
+
+  // ...and add it to all the pieces except the first.
+  auto carry_pieces = [&](MemSize begin, MemSize end) {
+    for (MemSize piece = begin + 1; piece < end + 1; ++piece) {
+      const T& carry = carries[piece - 1];
+      for (MemSize i = start(piece), e = start(piece + 1); i < e; ++i) {
+        destination[i] = op(carry, destination[i]);
+      }
+    }
+  };
+  WorkerPool::shared().run(piece_count - 1, 1, carry_pieces);
+}
+
+}  // namespace nu
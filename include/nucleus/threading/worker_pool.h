@@ -0,0 +1,86 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+
+#include "nucleus/containers/dynamic_array.h"
+#include "nucleus/macros.h"
+#include "nucleus/threading/thread.h"
+#include "nucleus/types.h"
+
+namespace nu {
+
+// A fixed set of threads that split ranges of work with the thread that hands them the work.  Most
+// code uses the process-wide pool from `WorkerPool::shared` through the algorithms in
+// "nucleus/threading/parallel.h".
+class WorkerPool {
+  NU_DELETE_COPY_AND_MOVE(WorkerPool);
+
+public:
+  // Called with a range of indices `[begin, end)` to work on.
+  using RangeFunction = void (*)(void* context, MemSize begin, MemSize end);
+
+  // A pool with no workers runs all the work on the calling thread.
+  explicit WorkerPool(MemSize worker_count);
+  ~WorkerPool();
+
+  // One worker for every hardware thread except the one calling into the pool.  The pool is created
+  // the first time it is used.
+  static WorkerPool& shared();
+
+  // True on the threads of any pool.  Work handed to a pool from one of its own workers runs on
+  // the calling thread, so nested parallel algorithms can not wait on each other.
+  static bool is_worker_thread();
+
+  MemSize worker_count() const {
+    return worker_count_;
+  }
+
+  // Calls `function` for ranges that together cover `[0, count)` and returns once all of them are
+  // done.  The calling thread works on the ranges too.  Threads take ranges of about half of what
+  // is left divided among them, so ranges start large and get smaller towards the end, which
+  // evens out the work when some ranges take longer than others.  No range is smaller than
+  // `min_range`, except the last one.
+  void run(MemSize count, MemSize min_range, RangeFunction function, void* context);
+
+  template <typename Func>
+  void run(MemSize count, MemSize min_range, Func& func) {
+    run(count, min_range, &call<Func>, &func);
+  }
+
+private:
+  struct Job {
+    RangeFunction function;
+    void* context;
+    MemSize count;
+    MemSize min_range;
+    // The start of the first range that no thread has taken yet.
+    std::atomic<MemSize> next_index{0};
+    // Workers that are taking ranges from this job.  Guarded by `lock_`.
+    MemSize helpers = 0;
+    Job* next_job = nullptr;
+  };
+
+  template <typename Func>
+  static void call(void* context, MemSize begin, MemSize end) {
+    (*static_cast<Func*>(context))(begin, end);
+  }
+
+  void worker_main();
+  void work_on(Job* job);
+  // Must be called with `lock_` held.
+  void unlink(Job* job);
+
+  std::mutex lock_;
+  std::condition_variable work_available_;
+  std::condition_variable helpers_done_;
+  // Jobs that might still have ranges left, oldest first.
+  Job* jobs_ = nullptr;
+  bool stopping_ = false;
+
+  MemSize worker_count_;
+  DynamicArray<JoinHandle> workers_;
+};
+
+}  // namespace nu
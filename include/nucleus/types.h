@@ -41,6 +41,9 @@ using PtrDiff = I32;
 // Type used for max alignment size.
 using MaxAlign = long double;
 
+// Data written by different threads is kept this far apart to avoid false sharing.
+constexpr MemSize CACHE_LINE_SIZE = 64;
+
 // Text Types
 
 using Char = char;
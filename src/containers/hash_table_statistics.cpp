@@ -0,0 +1,61 @@
+#include "nucleus/containers/hash_table_statistics.h"
+
+#include <string>
+
+#include "nucleus/profiling.h"
+
+namespace nu {
+
+namespace {
+
+void set_counter(detail::ProfileMetrics* metrics, StringView prefix, StringView name, F64 value) {
+  DynamicString counter_name{prefix};
+  counter_name.append('.');
+  counter_name.append(name);
+
+  metrics->setCounter(counter_name.view(), value);
+}
+
+// Histogram entries are named after the first probe length or cluster size they count.
+void set_counter(detail::ProfileMetrics* metrics, StringView prefix, StringView name,
+                 MemSize label, F64 value) {
+  DynamicString entry_name{name};
+  entry_name.append('.');
+  entry_name.append(std::to_string(label).c_str());
+
+  set_counter(metrics, prefix, entry_name.view(), value);
+}
+
+}  // namespace
+
+void HashTableStatistics::export_to_profiling(StringView prefix) const {
+  auto* metrics = detail::getCurrentProfileMetrics();
+  if (!metrics) {
+    return;
+  }
+
+  set_counter(metrics, prefix, "size", static_cast<F64>(size));
+  set_counter(metrics, prefix, "capacity", static_cast<F64>(capacity));
+  set_counter(metrics, prefix, "tombstones", static_cast<F64>(tombstones));
+  set_counter(metrics, prefix, "load_factor", load_factor);
+
+  set_counter(metrics, prefix, "average_hit_probe_length", average_hit_probe_length);
+  set_counter(metrics, prefix, "max_hit_probe_length", static_cast<F64>(max_hit_probe_length));
+  set_counter(metrics, prefix, "average_miss_probe_length", average_miss_probe_length);
+  set_counter(metrics, prefix, "max_miss_probe_length", static_cast<F64>(max_miss_probe_length));
+
+  for (MemSize i = 0; i < PROBE_LENGTH_BUCKETS; ++i) {
+    set_counter(metrics, prefix, "hit_probe_lengths", i + 1,
+                static_cast<F64>(hit_probe_lengths[i]));
+    set_counter(metrics, prefix, "miss_probe_lengths", i + 1,
+                static_cast<F64>(miss_probe_lengths[i]));
+  }
+
+  for (MemSize i = 0; i < CLUSTER_SIZE_BUCKETS; ++i) {
+    set_counter(metrics, prefix, "cluster_sizes", MemSize{1} << i,
+                static_cast<F64>(cluster_sizes[i]));
+  }
+  set_counter(metrics, prefix, "max_cluster_size", static_cast<F64>(max_cluster_size));
+}
+
+}  // namespace nu
@@ -0,0 +1,21 @@
+#include "nucleus/hash.h"
+
+#include <random>
+
+namespace nu {
+
+const HashKey& process_hash_key() {
+  static const HashKey key = [] {
+    std::random_device device;
+    auto next = [&device]() {
+      return (static_cast<U64>(device()) << 32) | static_cast<U64>(device());
+    };
+
+    U64 first = next();
+    return HashKey{first, next()};
+  }();
+
+  return key;
+}
+
+}  // namespace nu
@@ -0,0 +1,309 @@
+#include "nucleus/hasher.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+
+#include "nucleus/byte_order.h"
+#include "nucleus/config.h"
+#include "nucleus/logging.h"
+
+#if ARCH(CPU_X86_64)
+#if COMPILER(MSVC)
+#include <intrin.h>
+#endif
+#include <nmmintrin.h>
+#define HARDWARE_CRC32C 1
+#endif
+
+#if COMPILER(GCC)
+#define TARGET_SSE42 __attribute__((target("sse4.2")))
+#else
+#define TARGET_SSE42
+#endif
+
+namespace nu {
+
+namespace {
+
+U64 load_64(const U8* data) {
+  U64 value;
+  std::memcpy(&value, data, sizeof(value));
+  return byte_swap_if_big_endian(value);
+}
+
+U32 load_32(const U8* data) {
+  U32 value;
+  std::memcpy(&value, data, sizeof(value));
+  return byte_swap_if_big_endian(value);
+}
+
+// XXH64
+
+constexpr U64 PRIME_1 = 0x9E3779B185EBCA87ull;
+constexpr U64 PRIME_2 = 0xC2B2AE3D27D4EB4Full;
+constexpr U64 PRIME_3 = 0x165667B19E3779F9ull;
+constexpr U64 PRIME_4 = 0x85EBCA77C2B2AE63ull;
+constexpr U64 PRIME_5 = 0x27D4EB2F165667C5ull;
+
+U64 xxh64_round(U64 accumulator, U64 input) {
+  accumulator += input * PRIME_2;
+  accumulator = std::rotl(accumulator, 31);
+  return accumulator * PRIME_1;
+}
+
+U64 xxh64_merge_round(U64 hash, U64 accumulator) {
+  hash ^= xxh64_round(0, accumulator);
+  return hash * PRIME_1 + PRIME_4;
+}
+
+// CRC-32C
+
+constexpr U32 CRC32C_POLYNOMIAL = 0x82F63B78;
+
+// `tables[0]` is the classic byte at a time table.  `tables[k]` advances the CRC of a byte over `k`
+// more zero bytes, so 8 bytes can be looked up independently and combined.
+struct Crc32cTables {
+  U32 tables[8][256];
+};
+
+constexpr Crc32cTables build_crc32c_tables() {
+  Crc32cTables result{};
+
+  for (U32 i = 0; i < 256; ++i) {
+    U32 crc = i;
+    for (I32 bit = 0; bit < 8; ++bit) {
+      crc = (crc >> 1) ^ (CRC32C_POLYNOMIAL & (0u - (crc & 1u)));
+    }
+    result.tables[0][i] = crc;
+  }
+
+  for (U32 i = 0; i < 256; ++i) {
+    for (MemSize k = 1; k < 8; ++k) {
+      U32 previous = result.tables[k - 1][i];
+      result.tables[k][i] = (previous >> 8) ^ result.tables[0][previous & 0xFF];
+    }
+  }
+
+  return result;
+}
+
+constexpr Crc32cTables CRC32C_TABLES = build_crc32c_tables();
+
+#if defined(HARDWARE_CRC32C)
+
+TARGET_SSE42 U32 crc32c_hardware(U32 crc, const U8* data, MemSize size) {
+  U64 crc_64 = crc;
+  while (size >= 8) {
+    crc_64 = _mm_crc32_u64(crc_64, load_64(data));
+    data += 8;
+    size -= 8;
+  }
+
+  crc = static_cast<U32>(crc_64);
+  while (size > 0) {
+    crc = _mm_crc32_u8(crc, *data);
+    ++data;
+    --size;
+  }
+
+  return crc;
+}
+
+bool detect_sse42() {
+#if COMPILER(MSVC)
+  int info[4];
+  __cpuid(info, 1);
+  return (info[2] & (1 << 20)) != 0;
+#else
+  return __builtin_cpu_supports("sse4.2");
+#endif
+}
+
+#endif  // defined(HARDWARE_CRC32C)
+
+}  // namespace
+
+namespace detail {
+
+U32 crc32c_software(U32 crc, const U8* data, MemSize size) {
+  const auto& t = CRC32C_TABLES.tables;
+
+  while (size >= 8) {
+    U32 low = load_32(data) ^ crc;
+    U32 high = load_32(data + 4);
+    crc = t[7][low & 0xFF] ^ t[6][(low >> 8) & 0xFF] ^ t[5][(low >> 16) & 0xFF] ^ t[4][low >> 24] ^
+          t[3][high & 0xFF] ^ t[2][(high >> 8) & 0xFF] ^ t[1][(high >> 16) & 0xFF] ^
+          t[0][high >> 24];
+    data += 8;
+    size -= 8;
+  }
+
+  while (size > 0) {
+    crc = (crc >> 8) ^ t[0][(crc ^ *data) & 0xFF];
+    ++data;
+    --size;
+  }
+
+  return crc;
+}
+
+}  // namespace detail
+
+Hasher::Hasher(Algorithm algorithm, U64 seed) : algorithm_{algorithm}, seed_{seed} {
+  reset();
+}
+
+void Hasher::reset() {
+  length_ = 0;
+  buffered_ = 0;
+
+  switch (algorithm_) {
+    case Algorithm::XXH64:
+      accumulators_[0] = seed_ + PRIME_1 + PRIME_2;
+      accumulators_[1] = seed_ + PRIME_2;
+      accumulators_[2] = seed_;
+      accumulators_[3] = seed_ - PRIME_1;
+      break;
+
+    case Algorithm::CRC32C:
+      crc_ = ~static_cast<U32>(seed_);
+      break;
+  }
+}
+
+void Hasher::update(const void* data, MemSize size) {
+  DCHECK(data || size == 0);
+
+  auto* bytes = static_cast<const U8*>(data);
+  length_ += size;
+
+  switch (algorithm_) {
+    case Algorithm::XXH64:
+      update_xxh64(bytes, size);
+      break;
+
+    case Algorithm::CRC32C:
+#if defined(HARDWARE_CRC32C)
+      if (has_hardware_crc32c()) {
+        crc_ = crc32c_hardware(crc_, bytes, size);
+        break;
+      }
+#endif
+      crc_ = detail::crc32c_software(crc_, bytes, size);
+      break;
+  }
+}
+
+U64 Hasher::finish() const {
+  switch (algorithm_) {
+    case Algorithm::XXH64:
+      return finish_xxh64();
+
+    case Algorithm::CRC32C:
+      return ~crc_;
+  }
+
+  return 0;
+}
+
+// static
+bool Hasher::has_hardware_crc32c() {
+#if defined(HARDWARE_CRC32C)
+  static const bool has_sse42 = detect_sse42();
+  return has_sse42;
+#else
+  return false;
+#endif
+}
+
+void Hasher::update_xxh64(const U8* data, MemSize size) {
+  constexpr MemSize STRIPE = sizeof(buffer_);
+
+  // Complete a stripe that was started by an earlier call.
+  if (buffered_ > 0) {
+    MemSize count = std::min(size, STRIPE - buffered_);
+    std::memcpy(buffer_ + buffered_, data, count);
+    buffered_ += count;
+    data += count;
+    size -= count;
+
+    if (buffered_ < STRIPE) {
+      return;
+    }
+
+    for (MemSize i = 0; i < 4; ++i) {
+      accumulators_[i] = xxh64_round(accumulators_[i], load_64(buffer_ + i * 8));
+    }
+    buffered_ = 0;
+  }
+
+  // Four independent accumulators, so the multiplies of a stripe run in parallel.
+  U64 v1 = accumulators_[0];
+  U64 v2 = accumulators_[1];
+  U64 v3 = accumulators_[2];
+  U64 v4 = accumulators_[3];
+  while (size >= STRIPE) {
+    v1 = xxh64_round(v1, load_64(data));
+    v2 = xxh64_round(v2, load_64(data + 8));
+    v3 = xxh64_round(v3, load_64(data + 16));
+    v4 = xxh64_round(v4, load_64(data + 24));
+    data += STRIPE;
+    size -= STRIPE;
+  }
+  accumulators_[0] = v1;
+  accumulators_[1] = v2;
+  accumulators_[2] = v3;
+  accumulators_[3] = v4;
+
+  std::memcpy(buffer_, data, size);
+  buffered_ = size;
+}
+
+U64 Hasher::finish_xxh64() const {
+  U64 hash;
+  if (length_ >= sizeof(buffer_)) {
+    hash = std::rotl(accumulators_[0], 1) + std::rotl(accumulators_[1], 7) +
+           std::rotl(accumulators_[2], 12) + std::rotl(accumulators_[3], 18);
+    for (MemSize i = 0; i < 4; ++i) {
+      hash = xxh64_merge_round(hash, accumulators_[i]);
+    }
+  } else {
+    hash = seed_ + PRIME_5;
+  }
+
+  hash += length_;
+
+  const U8* data = buffer_;
+  MemSize size = buffered_;
+  while (size >= 8) {
+    hash ^= xxh64_round(0, load_64(data));
+    hash = std::rotl(hash, 27) * PRIME_1 + PRIME_4;
+    data += 8;
+    size -= 8;
+  }
+
+  if (size >= 4) {
+    hash ^= static_cast<U64>(load_32(data)) * PRIME_1;
+    hash = std::rotl(hash, 23) * PRIME_2 + PRIME_3;
+    data += 4;
+    size -= 4;
+  }
+
+  while (size > 0) {
+    hash ^= static_cast<U64>(*data) * PRIME_5;
+    hash = std::rotl(hash, 11) * PRIME_1;
+    ++data;
+    --size;
+  }
+
+  hash ^= hash >> 33;
+  hash *= PRIME_2;
+  hash ^= hash >> 29;
+  hash *= PRIME_3;
+  hash ^= hash >> 32;
+
+  return hash;
+}
+
+}  // namespace nu
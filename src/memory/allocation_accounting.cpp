@@ -0,0 +1,273 @@
+#include "nucleus/memory/allocation_accounting.h"
+
+#include <algorithm>
+#include <mutex>
+
+#include "nucleus/logging.h"
+
+namespace nu {
+
+namespace detail {
+
+std::atomic<bool> allocation_accounting_enabled{false};
+
+}  // namespace detail
+
+namespace {
+
+// Threads only add their byte counts to the shared totals once this many bytes have been allocated
+// or freed, so the totals are only touched once in a while.
+constexpr I64 FLUSH_THRESHOLD = 32 * 1024;
+
+StringView g_tag_names[MAX_ALLOCATION_TAGS] = {
+    "general", "dynamic_array", "dynamic_string", "hash_table", "stable_pool", "string_pool",
+    "arena",
+};
+
+// Only the owning thread writes to these, so a load followed by a store is enough to update them,
+// but other threads read them for snapshots.
+template <typename T>
+void add_relaxed(std::atomic<T>& counter, T value) {
+  counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+}
+
+struct TagTotals {
+  std::atomic<I64> live_bytes{0};
+  std::atomic<I64> peak_bytes{0};
+  // Counts of threads that have exited.
+  std::atomic<U64> allocations{0};
+  std::atomic<U64> deallocations{0};
+
+  // `pending_peak` is the most bytes that were live on top of the totals while they were pending.
+  void add_bytes(I64 bytes, I64 pending_peak) {
+    I64 live = live_bytes.fetch_add(bytes, std::memory_order_relaxed);
+    I64 new_peak = live + std::max(bytes, pending_peak);
+
+    I64 peak = peak_bytes.load(std::memory_order_relaxed);
+    while (new_peak > peak &&
+           !peak_bytes.compare_exchange_weak(peak, new_peak, std::memory_order_relaxed)) {
+    }
+  }
+};
+
+TagTotals g_totals[MAX_ALLOCATION_TAGS];
+
+struct TagCounters {
+  std::atomic<U64> allocations{0};
+  std::atomic<U64> deallocations{0};
+  // Bytes allocated minus bytes freed that are not in `TagTotals::live_bytes` yet.
+  std::atomic<I64> pending_bytes{0};
+  // The highest `pending_bytes` since they were last added to the totals.
+  std::atomic<I64> pending_peak{0};
+};
+
+// Tags made with a cast instead of `user_allocation_tag` can be out of range.  Those are counted
+// as `General` in release builds rather than written past the counters.
+MemSize tag_index(AllocationTag tag) {
+  auto index = static_cast<MemSize>(tag);
+  DCHECK(index < MAX_ALLOCATION_TAGS) << "Allocation tag out of range.";
+
+  return index < MAX_ALLOCATION_TAGS ? index : static_cast<MemSize>(AllocationTag::General);
+}
+
+class ThreadCounters;
+
+std::mutex g_threads_lock;
+ThreadCounters* g_threads = nullptr;
+
+class ThreadCounters {
+public:
+  ThreadCounters();
+  ~ThreadCounters();
+
+  void count(AllocationTag tag, I64 bytes, bool is_allocation) {
+    auto index = tag_index(tag);
+    auto& counters = tags_[index];
+    add_relaxed<U64>(is_allocation ? counters.allocations : counters.deallocations, 1);
+
+    I64 pending = counters.pending_bytes.load(std::memory_order_relaxed) + bytes;
+    I64 pending_peak = std::max(counters.pending_peak.load(std::memory_order_relaxed), pending);
+    if (pending >= FLUSH_THRESHOLD || pending <= -FLUSH_THRESHOLD) {
+      g_totals[index].add_bytes(pending, pending_peak);
+      pending = 0;
+      pending_peak = 0;
+    }
+    counters.pending_bytes.store(pending, std::memory_order_relaxed);
+    counters.pending_peak.store(pending_peak, std::memory_order_relaxed);
+  }
+
+  // Adds everything counted by this thread to the totals.
+  void retire() {
+    for (MemSize i = 0; i < MAX_ALLOCATION_TAGS; ++i) {
+      auto& counters = tags_[i];
+      g_totals[i].add_bytes(counters.pending_bytes.exchange(0, std::memory_order_relaxed),
+                            counters.pending_peak.exchange(0, std::memory_order_relaxed));
+      g_totals[i].allocations.fetch_add(counters.allocations.exchange(0),
+                                        std::memory_order_relaxed);
+      g_totals[i].deallocations.fetch_add(counters.deallocations.exchange(0),
+                                          std::memory_order_relaxed);
+    }
+  }
+
+  void reset() {
+    for (auto& counters : tags_) {
+      counters.allocations.store(0, std::memory_order_relaxed);
+      counters.deallocations.store(0, std::memory_order_relaxed);
+      counters.pending_bytes.store(0, std::memory_order_relaxed);
+      counters.pending_peak.store(0, std::memory_order_relaxed);
+    }
+  }
+
+  void add_to(AllocationSnapshot* snapshot) const {
+    for (MemSize i = 0; i < MAX_ALLOCATION_TAGS; ++i) {
+      auto& stats = snapshot->tags[i];
+      stats.allocations += tags_[i].allocations.load(std::memory_order_relaxed);
+      stats.deallocations += tags_[i].deallocations.load(std::memory_order_relaxed);
+      stats.live_bytes += tags_[i].pending_bytes.load(std::memory_order_relaxed);
+      stats.peak_bytes += tags_[i].pending_peak.load(std::memory_order_relaxed);
+    }
+  }
+
+  ThreadCounters* next() const {
+    return next_;
+  }
+
+private:
+  TagCounters tags_[MAX_ALLOCATION_TAGS];
+
+  ThreadCounters* prev_ = nullptr;
+  ThreadCounters* next_ = nullptr;
+};
+
+ThreadCounters::ThreadCounters() {
+  std::lock_guard<std::mutex> locker{g_threads_lock};
+  next_ = g_threads;
+  if (g_threads) {
+    g_threads->prev_ = this;
+  }
+  g_threads = this;
+}
+
+ThreadCounters::~ThreadCounters() {
+  std::lock_guard<std::mutex> locker{g_threads_lock};
+  retire();
+
+  if (prev_) {
+    prev_->next_ = next_;
+  } else {
+    g_threads = next_;
+  }
+  if (next_) {
+    next_->prev_ = prev_;
+  }
+}
+
+// Set once the counters of this thread are destroyed, so allocations made by destructors that run
+// after them during thread exit go straight to the totals.
+thread_local bool t_counters_destroyed = false;
+
+struct ThreadCountersHolder {
+  ThreadCounters counters;
+
+  ~ThreadCountersHolder() {
+    t_counters_destroyed = true;
+  }
+};
+
+ThreadCounters* current_thread_counters() {
+  if (t_counters_destroyed) {
+    return nullptr;
+  }
+
+  thread_local ThreadCountersHolder holder;
+  return &holder.counters;
+}
+
+void count(AllocationTag tag, I64 bytes, bool is_allocation) {
+  auto* counters = current_thread_counters();
+  if (counters) {
+    counters->count(tag, bytes, is_allocation);
+    return;
+  }
+
+  auto& totals = g_totals[tag_index(tag)];
+  totals.add_bytes(bytes, 0);
+  (is_allocation ? totals.allocations : totals.deallocations).fetch_add(1);
+}
+
+}  // namespace
+
+void set_allocation_tag_name(AllocationTag tag, StringView name) {
+  auto index = static_cast<MemSize>(tag);
+  DCHECK(index < MAX_ALLOCATION_TAGS) << "Allocation tag out of range.";
+
+  if (index < MAX_ALLOCATION_TAGS) {
+    g_tag_names[index] = name;
+  }
+}
+
+StringView allocation_tag_name(AllocationTag tag) {
+  return g_tag_names[tag_index(tag)];
+}
+
+void enable_allocation_accounting(bool enabled) {
+  detail::allocation_accounting_enabled.store(enabled, std::memory_order_relaxed);
+}
+
+namespace detail {
+
+void count_allocation(AllocationTag tag, MemSize size) {
+  count(tag, static_cast<I64>(size), true);
+}
+
+void count_deallocation(AllocationTag tag, MemSize size) {
+  count(tag, -static_cast<I64>(size), false);
+}
+
+}  // namespace detail
+
+AllocationSnapshot take_allocation_snapshot() {
+  AllocationSnapshot result;
+
+  for (MemSize i = 0; i < MAX_ALLOCATION_TAGS; ++i) {
+    auto& stats = result.tags[i];
+    stats.live_bytes = g_totals[i].live_bytes.load(std::memory_order_relaxed);
+    stats.peak_bytes = stats.live_bytes;
+    stats.allocations = g_totals[i].allocations.load(std::memory_order_relaxed);
+    stats.deallocations = g_totals[i].deallocations.load(std::memory_order_relaxed);
+  }
+
+  {
+    std::lock_guard<std::mutex> locker{g_threads_lock};
+    for (auto* thread = g_threads; thread; thread = thread->next()) {
+      thread->add_to(&result);
+    }
+  }
+
+  // The peaks of the bytes threads have not added to the totals yet can be higher than the peak of
+  // the totals.
+  for (MemSize i = 0; i < MAX_ALLOCATION_TAGS; ++i) {
+    auto& stats = result.tags[i];
+    stats.peak_bytes = std::max({g_totals[i].peak_bytes.load(std::memory_order_relaxed),
+                                 stats.peak_bytes, stats.live_bytes});
+  }
+
+  return result;
+}
+
+void reset_allocation_accounting() {
+  std::lock_guard<std::mutex> locker{g_threads_lock};
+
+  for (auto& totals : g_totals) {
+    totals.live_bytes.store(0, std::memory_order_relaxed);
+    totals.peak_bytes.store(0, std::memory_order_relaxed);
+    totals.allocations.store(0, std::memory_order_relaxed);
+    totals.deallocations.store(0, std::memory_order_relaxed);
+  }
+
+  for (auto* thread = g_threads; thread; thread = thread->next()) {
+    thread->reset();
+  }
+}
+
+}  // namespace nu
@@ -0,0 +1,108 @@
+#include "nucleus/memory/arena.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+namespace nu {
+
+Arena::Arena(MemSize first_block_size) : first_block_size_{first_block_size} {
+  DCHECK(first_block_size > 0);
+}
+
+Arena::~Arena() {
+  Block* block = first_;
+  while (block) {
+    Block* next = block->next;
+    record_deallocation(AllocationTag::Arena, sizeof(Block) + block->size);
+    std::free(block);
+    block = next;
+  }
+}
+
+void* Arena::reallocate(void* memory, MemSize old_size, MemSize new_size, MemSize alignment) {
+  if (is_last(memory, old_size)) {
+    auto start = static_cast<MemSize>(static_cast<U8*>(memory) - current_->data());
+    if (start + new_size <= current_->size) {
+      offset_ = start + new_size;
+      return memory;
+    }
+  }
+
+  void* result = allocate(new_size, alignment);
+  std::memcpy(result, memory, std::min(old_size, new_size));
+  return result;
+}
+
+void Arena::deallocate(void* memory, MemSize size) {
+  if (is_last(memory, size)) {
+    offset_ -= size;
+  }
+}
+
+void Arena::reset() {
+  current_ = nullptr;
+  offset_ = 0;
+}
+
+MemSize Arena::bytes_used() const {
+  if (!current_) {
+    return 0;
+  }
+
+  MemSize result = offset_;
+  for (Block* block = first_; block != current_; block = block->next) {
+    result += block->size;
+  }
+  return result;
+}
+
+MemSize Arena::bytes_reserved() const {
+  MemSize result = 0;
+  for (Block* block = first_; block; block = block->next) {
+    result += block->size;
+  }
+  return result;
+}
+
+void* Arena::allocate_slow(MemSize size, MemSize alignment) {
+  Block* next = current_ ? current_->next : first_;
+
+  // Blocks after the current one are left over from before a reset or a rewind.
+  if (next) {
+    MemSize start = aligned_offset(next, 0, alignment);
+    if (start + size <= next->size) {
+      current_ = next;
+      offset_ = start + size;
+      return next->data() + start;
+    }
+  }
+
+  // Each block is twice the size of the one before it, and large enough for the allocation even if
+  // it needs padding to be aligned.
+  MemSize block_size = current_ ? current_->size * 2 : first_block_size_;
+  while (block_size < size + alignment) {
+    block_size *= 2;
+  }
+
+  record_allocation(AllocationTag::Arena, sizeof(Block) + block_size);
+  auto* block = static_cast<Block*>(std::malloc(sizeof(Block) + block_size));
+  DCHECK(block) << "Out of memory.";
+  block->size = block_size;
+
+  // The new block goes right after the current one, in front of any left over block that was too
+  // small, so blocks stay in the order they are used.
+  block->next = next;
+  if (current_) {
+    current_->next = block;
+  } else {
+    first_ = block;
+  }
+
+  MemSize start = aligned_offset(block, 0, alignment);
+  current_ = block;
+  offset_ = start + size;
+  return block->data() + start;
+}
+
+}  // namespace nu
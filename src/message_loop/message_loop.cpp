@@ -28,8 +28,14 @@ void MessageLoop::run() {
   run_internal();
 }
 
+void MessageLoop::set_idle_callback(Function<void()> callback) {
+  idle_callback_ = std::move(callback);
+}
+
 bool MessageLoop::progress() {
-  DynamicArray<Function<void()>> tasks_to_run;
+  // Most batches are small, so swapping the inline storage of the two arrays is cheaper than a heap
+  // allocation for every batch of tasks posted.
+  InlineDynamicArray<Function<void()>> tasks_to_run;
 
   {
     std::lock_guard<std::mutex> locker{incoming_tasks_lock_};
@@ -37,8 +43,14 @@ bool MessageLoop::progress() {
   }
 
   // If we fetched the tasks from the incoming queue and it's empty, then we are idle.
-  if (quit_on_idle_ && tasks_to_run.empty()) {
-    return false;
+  if (tasks_to_run.empty()) {
+    if (!idle_callback_.empty()) {
+      idle_callback_();
+    }
+
+    if (quit_on_idle_) {
+      return false;
+    }
   }
 
   for (const auto& task : tasks_to_run) {
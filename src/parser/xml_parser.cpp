@@ -6,12 +6,14 @@ namespace nu {
 
 namespace {
 
-DynamicArray<XMLNode> readXMLAttributes(Tokenizer& tokenizer) {
-  DynamicArray<XMLNode> result;
+template <typename Allocator>
+BasicXMLAttributes<Allocator> readXMLAttributes(Tokenizer& tokenizer, const Allocator& allocator) {
+  BasicXMLAttributes<Allocator> result{allocator};
   return result;
 }
 
-bool readXMLTagLine(Tokenizer& tokenizer) {
+template <typename Allocator>
+bool readXMLTagLine(Tokenizer& tokenizer, const Allocator& allocator) {
   Token token;
 
   token = tokenizer.consumeNextToken();
@@ -29,23 +31,32 @@ bool readXMLTagLine(Tokenizer& tokenizer) {
     return false;
   }
 
-  auto attributes = readXMLAttributes(tokenizer);
+  auto attributes = readXMLAttributes(tokenizer, allocator);
 
   return true;
 }
 
-}  // namespace
-
-XMLDocument parseXMLDocument(const StringView& source) {
+template <typename Allocator>
+BasicXMLDocument<Allocator> parseDocument(const StringView& source, const Allocator& allocator) {
   auto tokenizer = Tokenizer(source);
 
-  XMLDocument result;
+  BasicXMLDocument<Allocator> result{allocator};
 
-  if (!readXMLTagLine(tokenizer)) {
-    return {};
+  if (!readXMLTagLine(tokenizer, allocator)) {
+    return BasicXMLDocument<Allocator>{allocator};
   }
 
   return result;
 }
 
+}  // namespace
+
+XMLDocument parseXMLDocument(const StringView& source) {
+  return parseDocument(source, DefaultAllocator{});
+}
+
+ArenaXMLDocument parseXMLDocument(const StringView& source, Arena* arena) {
+  return parseDocument(source, ArenaAllocator{arena});
+}
+
 }  // namespace nu
@@ -21,6 +21,8 @@ auto ProfileMetrics::reset() -> void {
 
   m_current = &m_root;
   m_root.children = nullptr;
+
+  m_counters.clear();
 }
 
 auto ProfileMetrics::startBlock(StringView) -> void {
@@ -61,6 +63,11 @@ auto ProfileMetrics::stopBlock() -> void {
   }
 }
 
+auto ProfileMetrics::setCounter(StringView name, F64 value) -> void {
+  // Only allocates the name the first time the counter is set.
+  m_counters.insert_or_assign(name, value);
+}
+
 ProfileMetrics* getCurrentProfileMetrics() {
   return g_globalProfileMetrics;
 }
@@ -5,10 +5,12 @@ namespace nu {
 DynamicArray<U8> readEntireStream(InputStream* inputStream) {
   auto bytesRemaining = inputStream->getBytesRemaining();
 
+  // Every byte is about to be overwritten, so don't clear them first.
   DynamicArray<U8> result;
-  result.resize(bytesRemaining);
+  result.resize_uninitialized(bytesRemaining);
 
-  inputStream->read(result.data(), bytesRemaining);
+  auto bytesRead = inputStream->read(result.data(), bytesRemaining);
+  result.resize_uninitialized(bytesRead);
 
   return result;
 }
@@ -0,0 +1,43 @@
+#include "nucleus/streams/checksum_input_stream.h"
+
+#include "nucleus/logging.h"
+
+namespace nu {
+
+ChecksumInputStream::ChecksumInputStream(InputStream* source, Hasher* hasher)
+  : m_source{source}, m_hasher{hasher} {
+  DCHECK(m_source);
+  DCHECK(m_hasher);
+}
+
+ChecksumInputStream::~ChecksumInputStream() = default;
+
+ChecksumInputStream::SizeType ChecksumInputStream::getSize() {
+  return m_source->getSize();
+}
+
+ChecksumInputStream::SizeType ChecksumInputStream::read(void* destination, SizeType bytesToRead) {
+  SizeType bytesRead = m_source->read(destination, bytesToRead);
+  m_hasher->update(destination, bytesRead);
+  return bytesRead;
+}
+
+bool ChecksumInputStream::isExhausted() {
+  return m_source->isExhausted();
+}
+
+bool ChecksumInputStream::setPosition(SizeType newPosition) {
+  SizeType position = getPosition();
+  if (newPosition < position) {
+    return false;
+  }
+
+  skip(newPosition - position);
+  return getPosition() == newPosition;
+}
+
+ChecksumInputStream::SizeType ChecksumInputStream::getPosition() {
+  return m_source->getPosition();
+}
+
+}  // namespace nu
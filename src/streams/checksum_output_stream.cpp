@@ -0,0 +1,20 @@
+#include "nucleus/streams/checksum_output_stream.h"
+
+#include "nucleus/logging.h"
+
+namespace nu {
+
+ChecksumOutputStream::ChecksumOutputStream(OutputStream* destination, Hasher* hasher)
+  : OutputStream{OutputStreamMode::Binary}, m_destination{destination}, m_hasher{hasher} {
+  DCHECK(m_destination);
+  DCHECK(m_hasher);
+}
+
+ChecksumOutputStream::SizeType ChecksumOutputStream::write(const void* buffer, SizeType size) {
+  // Only the bytes that made it to the destination are hashed.
+  SizeType bytesWritten = m_destination->write(buffer, size);
+  m_hasher->update(buffer, bytesWritten);
+  return bytesWritten;
+}
+
+}  // namespace nu
@@ -8,7 +8,7 @@ DynamicBufferOutputStream::SizeType DynamicBufferOutputStream::write(const void*
                                                                      SizeType size) {
   // Expand the buffer if there is not enough space already.
   if (m_currentPosition + size > m_buffer.size()) {
-    m_buffer.resize(m_currentPosition + size);
+    m_buffer.resize_uninitialized(m_currentPosition + size);
   }
 
   // Write the source into the buffer.
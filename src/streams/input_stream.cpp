@@ -22,7 +22,7 @@ void InputStream::skip(SizeType numberOfBytes) {
       std::min(numberOfBytes, static_cast<SizeType>(kBufferedSizeToSkip));
 
   nu::DynamicArray<I8> temp;
-  temp.resize(skipBufferSize);
+  temp.resize_uninitialized(skipBufferSize);
 
   while (numberOfBytes != 0 && !isExhausted()) {
     numberOfBytes -=
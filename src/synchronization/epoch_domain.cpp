@@ -0,0 +1,94 @@
+#include "nucleus/synchronization/epoch_domain.h"
+
+#include <algorithm>
+#include <limits>
+
+#include "nucleus/logging.h"
+#include "nucleus/synchronization/auto_lock.h"
+
+namespace nu {
+
+EpochDomain::Participant::Participant(EpochDomain* domain)
+  : domain_{domain}, epoch_{domain->global_epoch_.load(std::memory_order_acquire)} {
+  AutoLock<Lock> locker{domain_->lock_};
+  domain_->participants_.pushBack(this);
+}
+
+EpochDomain::Participant::~Participant() {
+  {
+    AutoLock<Lock> locker{domain_->lock_};
+    domain_->participants_.remove(this);
+  }
+
+  // This participant might have been the only one holding back some retired objects.
+  domain_->collect();
+}
+
+void EpochDomain::Participant::quiescent() {
+  // The release store makes sure every read this thread did before is done by the time a writer
+  // sees the new epoch and deletes what it read.
+  epoch_.store(domain_->global_epoch_.load(std::memory_order_acquire), std::memory_order_release);
+}
+
+EpochDomain::EpochDomain() = default;
+
+EpochDomain::~EpochDomain() {
+  DCHECK(participants_.empty()) << "Participants should be destroyed before their domain.";
+
+  // Deleters might retire more objects while they run.
+  while (!retired_.empty()) {
+    DynamicArray<Retired> retired;
+    retired.swap(retired_);
+    for (auto& entry : retired) {
+      entry.deleter(entry.object);
+    }
+  }
+}
+
+void EpochDomain::retire(void* object, Deleter deleter) {
+  {
+    AutoLock<Lock> locker{lock_};
+
+    // The object was unpublished before the epoch moves on, so a participant that sees the new
+    // epoch can not find the object anymore.
+    U64 epoch = global_epoch_.fetch_add(1, std::memory_order_acq_rel);
+    retired_.pushBack({epoch, object, deleter});
+  }
+
+  collect();
+}
+
+void EpochDomain::collect() {
+  DynamicArray<Retired> expired;
+
+  {
+    AutoLock<Lock> locker{lock_};
+
+    U64 oldest_epoch = std::numeric_limits<U64>::max();
+    for (auto* participant : participants_) {
+      oldest_epoch = std::min(oldest_epoch, participant->epoch_.load(std::memory_order_acquire));
+    }
+
+    MemSize kept = 0;
+    for (auto& retired : retired_) {
+      if (retired.epoch < oldest_epoch) {
+        expired.pushBack(retired);
+      } else {
+        retired_[kept++] = retired;
+      }
+    }
+    retired_.resize(kept);
+  }
+
+  // Deleters run without the lock, so they can retire objects of their own.
+  for (auto& retired : expired) {
+    retired.deleter(retired.object);
+  }
+}
+
+MemSize EpochDomain::pending() const {
+  AutoLock<Lock> locker{lock_};
+  return retired_.size();
+}
+
+}  // namespace nu
@@ -1,14 +1,43 @@
-
 #include "nucleus/synchronization/lock.h"
 
 namespace nu {
 
-Lock::Lock() = default;
+#if OS(WIN)
+
+Lock::Lock() {
+  InitializeCriticalSection(&handle_);
+}
+
+Lock::~Lock() {
+  DeleteCriticalSection(&handle_);
+}
+
+void Lock::acquire() {
+  EnterCriticalSection(&handle_);
+}
+
+void Lock::release() {
+  LeaveCriticalSection(&handle_);
+}
+
+#elif OS(POSIX)
+
+Lock::Lock() {
+  pthread_mutex_init(&handle_, nullptr);
+}
+
+Lock::~Lock() {
+  pthread_mutex_destroy(&handle_);
+}
 
-Lock::~Lock() = default;
+void Lock::acquire() {
+  pthread_mutex_lock(&handle_);
+}
 
-void Lock::acquire() {}
+void Lock::release() {
+  pthread_mutex_unlock(&handle_);
+}
 
-void Lock::release() {}
+#endif
 
 }  // namespace nu
@@ -0,0 +1,134 @@
+#include "nucleus/threading/worker_pool.h"
+
+#include <algorithm>
+#include <thread>
+
+namespace nu {
+
+namespace {
+
+thread_local bool t_is_worker_thread = false;
+
+}  // namespace
+
+WorkerPool::WorkerPool(MemSize worker_count) : worker_count_{worker_count} {
+  workers_.reserve(worker_count);
+  for (MemSize i = 0; i < worker_count; ++i) {
+    workers_.pushBack(spawn_thread([this]() {
+      worker_main();
+    }));
+  }
+}
+
+WorkerPool::~WorkerPool() {
+  {
+    std::lock_guard<std::mutex> locker{lock_};
+    stopping_ = true;
+  }
+  work_available_.notify_all();
+
+  // Joins all the workers.
+  workers_.clear();
+}
+
+// static
+WorkerPool& WorkerPool::shared() {
+  static WorkerPool pool{std::max<MemSize>(std::thread::hardware_concurrency(), 1) - 1};
+  return pool;
+}
+
+// static
+bool WorkerPool::is_worker_thread() {
+  return t_is_worker_thread;
+}
+
+void WorkerPool::run(MemSize count, MemSize min_range, RangeFunction function, void* context) {
+  DCHECK(min_range > 0);
+
+  if (count <= min_range || worker_count_ == 0 || is_worker_thread()) {
+    if (count > 0) {
+      function(context, 0, count);
+    }
+    return;
+  }
+
+  Job job;
+  job.function = function;
+  job.context = context;
+  job.count = count;
+  job.min_range = min_range;
+
+  {
+    std::lock_guard<std::mutex> locker{lock_};
+    Job** last = &jobs_;
+    while (*last) {
+      last = &(*last)->next_job;
+    }
+    *last = &job;
+  }
+  work_available_.notify_all();
+
+  work_on(&job);
+
+  // All the ranges are taken, but workers might still be busy with theirs.  The job lives on this
+  // stack, so no worker may be left holding on to it.
+  std::unique_lock<std::mutex> locker{lock_};
+  unlink(&job);
+  helpers_done_.wait(locker, [&job]() {
+    return job.helpers == 0;
+  });
+}
+
+void WorkerPool::worker_main() {
+  t_is_worker_thread = true;
+
+  std::unique_lock<std::mutex> locker{lock_};
+  for (;;) {
+    work_available_.wait(locker, [this]() {
+      return stopping_ || jobs_;
+    });
+
+    if (!jobs_) {
+      return;
+    }
+
+    Job* job = jobs_;
+    ++job->helpers;
+    locker.unlock();
+
+    work_on(job);
+
+    locker.lock();
+    // There is nothing left to take from the job, so no other worker has to look at it.
+    unlink(job);
+    if (--job->helpers == 0) {
+      helpers_done_.notify_all();
+    }
+  }
+}
+
+void WorkerPool::work_on(Job* job) {
+  MemSize participants = worker_count_ + 1;
+
+  MemSize begin = job->next_index.load(std::memory_order_relaxed);
+  while (begin < job->count) {
+    MemSize range = std::max(job->min_range, (job->count - begin) / (participants * 2));
+    MemSize end = std::min(job->count, begin + range);
+    if (job->next_index.compare_exchange_weak(begin, end, std::memory_order_relaxed)) {
+      job->function(job->context, begin, end);
+      begin = job->next_index.load(std::memory_order_relaxed);
+    }
+  }
+}
+
+void WorkerPool::unlink(Job* job) {
+  for (Job** current = &jobs_; *current; current = &(*current)->next_job) {
+    if (*current == job) {
+      *current = job->next_job;
+      job->next_job = nullptr;
+      return;
+    }
+  }
+}
+
+}  // namespace nu
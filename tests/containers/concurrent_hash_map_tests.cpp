@@ -0,0 +1,124 @@
+#include <catch2/catch.hpp>
+
+#include <atomic>
+
+#include "nucleus/containers/concurrent_hash_map.h"
+#include "nucleus/threading/thread.h"
+
+namespace nu {
+
+TEST_CASE("ConcurrentHashMap") {
+  ConcurrentHashMap<I32, I32> map;
+
+  SECTION("basic") {
+    CHECK(map.size() == 0);
+    CHECK(!map.contains_key(10));
+
+    CHECK(map.insert(10, 20));
+    CHECK(!map.insert(10, 30));
+    CHECK(map.size() == 1);
+
+    I32 value = 0;
+    CHECK(map.find(10, &value));
+    CHECK(value == 30);
+    CHECK(!map.find(11, &value));
+
+    CHECK(map.find(10, [](I32& found) {
+      found += 1;
+    }));
+    CHECK(map.find(10, &value));
+    CHECK(value == 31);
+
+    CHECK(map.remove(10));
+    CHECK(!map.remove(10));
+    CHECK(map.size() == 0);
+  }
+
+  SECTION("upsert") {
+    auto add = [](I32& existing, I32&& value) {
+      existing += value;
+    };
+
+    CHECK(map.upsert(1, 5, add));
+    CHECK(!map.upsert(1, 6, add));
+
+    I32 value = 0;
+    CHECK(map.find(1, &value));
+    CHECK(value == 11);
+  }
+
+  SECTION("for each shard") {
+    for (I32 i = 0; i < 1000; ++i) {
+      map.insert(i, i);
+    }
+
+    // Shards can be visited on several threads, so only record what was seen and check it after.
+    std::atomic<MemSize> visits[map.shard_count()] = {};
+    std::atomic<MemSize> sizes[map.shard_count()] = {};
+    map.for_each_shard([&](MemSize shard_index, ConcurrentHashMap<I32, I32>::MapType& shard) {
+      visits[shard_index].fetch_add(1);
+      sizes[shard_index].fetch_add(shard.size());
+    });
+
+    MemSize items = 0;
+    for (MemSize i = 0; i < map.shard_count(); ++i) {
+      CHECK(visits[i].load() == 1);
+      // Keys should be spread over all the shards.
+      CHECK(sizes[i].load() > 0);
+      items += sizes[i].load();
+    }
+    CHECK(items == 1000);
+  }
+}
+
+TEST_CASE("ConcurrentHashMap with a seeded hasher") {
+  ConcurrentHashMap<I32, I32, 16, SeededHash> map;
+
+  for (I32 i = 0; i < 100; ++i) {
+    CHECK(map.insert(i, i * 2));
+  }
+
+  CHECK(map.size() == 100);
+  for (I32 i = 0; i < 100; ++i) {
+    I32 value = 0;
+    CHECK(map.find(i, &value));
+    CHECK(value == i * 2);
+  }
+  CHECK(map.remove(50));
+  CHECK(!map.contains_key(50));
+}
+
+TEST_CASE("ConcurrentHashMap from many threads") {
+  ConcurrentHashMap<I32, I32> map;
+
+  auto work = [&map](I32 first) {
+    return [&map, first]() {
+      for (I32 i = 0; i < 1000; ++i) {
+        // Every thread inserts its own keys and counts into some shared ones.
+        map.insert(first + i, i);
+        map.upsert(i % 10, 1, [](I32& existing, I32&& value) {
+          existing += value;
+        });
+      }
+    };
+  };
+
+  {
+    auto t1 = spawn_thread(work(1000));
+    auto t2 = spawn_thread(work(2000));
+    auto t3 = spawn_thread(work(3000));
+    auto t4 = spawn_thread(work(4000));
+  }
+
+  CHECK(map.size() == 4010);
+
+  I32 total = 0;
+  for (I32 i = 0; i < 10; ++i) {
+    I32 count = 0;
+    CHECK(map.find(i, &count));
+    total += count;
+  }
+  CHECK(total == 4000);
+}
+
+}  // namespace nu
@@ -2,10 +2,13 @@
 #include <catch2/catch.hpp>
 
 #include "nucleus/containers/dynamic_array.h"
+#include "nucleus/testing/counting_allocator.h"
 #include "nucleus/testing/lifetime_tracker.h"
 
 namespace nu {
 
+using testing::AllocationCounts;
+using testing::CountingAllocator;
 using testing::LifetimeTracker;
 
 TEST_CASE("DynamicArray construct") {
@@ -343,6 +346,109 @@ TEST_CASE("remove range calls destructors") {
   REQUIRE(LifetimeTracker::copies == 0);
 }
 
+TEST_CASE("swapRemove moves the last element into place") {
+  nu::DynamicArray<LifetimeTracker> buffer;
+  buffer.emplaceBack(1, 2);
+  buffer.emplaceBack(3, 4);
+  buffer.emplaceBack(5, 6);
+  buffer.emplaceBack(7, 8);
+
+  LifetimeTracker::reset();
+  buffer.swapRemove(buffer.begin() + 1);
+  CHECK(LifetimeTracker::destroys == 1);
+  CHECK(LifetimeTracker::moves == 1);
+  CHECK(LifetimeTracker::copies == 0);
+
+  REQUIRE(buffer.size() == 3);
+  CHECK(buffer[0] == LifetimeTracker{1, 2});
+  CHECK(buffer[1] == LifetimeTracker{7, 8});
+  CHECK(buffer[2] == LifetimeTracker{5, 6});
+
+  buffer.swapRemove(buffer.end() - 1);
+  REQUIRE(buffer.size() == 2);
+  CHECK(buffer[1] == LifetimeTracker{7, 8});
+}
+
+TEST_CASE("removeIf keeps the order of the other elements") {
+  nu::DynamicArray<I32> buffer;
+  for (I32 i = 0; i < 10; ++i) {
+    buffer.pushBack(i);
+  }
+
+  auto removed = buffer.removeIf([](I32 value) {
+    return value % 3 == 0;
+  });
+
+  CHECK(removed == 4);
+  REQUIRE(buffer.size() == 6);
+  CHECK(buffer[0] == 1);
+  CHECK(buffer[1] == 2);
+  CHECK(buffer[2] == 4);
+  CHECK(buffer[3] == 5);
+  CHECK(buffer[4] == 7);
+  CHECK(buffer[5] == 8);
+
+  CHECK(buffer.removeIf([](I32) { return false; }) == 0);
+  CHECK(buffer.size() == 6);
+
+  CHECK(buffer.removeIf([](I32) { return true; }) == 6);
+  CHECK(buffer.empty());
+}
+
+TEST_CASE("removeIf destroys the removed elements") {
+  LifetimeTracker::reset();
+
+  {
+    nu::DynamicArray<LifetimeTracker> buffer;
+    for (I32 i = 0; i < 6; ++i) {
+      buffer.emplaceBack(i, i);
+    }
+
+    buffer.removeIf([](const LifetimeTracker& tracker) {
+      return tracker.a() % 2 == 0;
+    });
+
+    REQUIRE(buffer.size() == 3);
+    CHECK(buffer[0].a() == 1);
+    CHECK(buffer[1].a() == 3);
+    CHECK(buffer[2].a() == 5);
+
+    // Only the three removed elements are destroyed, the rest are moved with move assignment.
+    CHECK(LifetimeTracker::destroys == 3);
+    CHECK(LifetimeTracker::copies == 0);
+  }
+
+  CHECK(LifetimeTracker::creates == LifetimeTracker::destroys);
+}
+
+TEST_CASE("removeAll removes every matching element") {
+  nu::DynamicArray<I32> buffer;
+  for (I32 value : {1, 2, 1, 3, 1}) {
+    buffer.pushBack(value);
+  }
+
+  CHECK(buffer.removeAll(1) == 3);
+  REQUIRE(buffer.size() == 2);
+  CHECK(buffer[0] == 2);
+  CHECK(buffer[1] == 3);
+
+  CHECK(buffer.removeAll(5) == 0);
+  CHECK(buffer.size() == 2);
+}
+
+TEST_CASE("retain keeps the matching elements") {
+  nu::DynamicArray<I32> buffer;
+  for (I32 i = 0; i < 8; ++i) {
+    buffer.pushBack(i);
+  }
+
+  CHECK(buffer.retain([](I32 value) { return value >= 5; }) == 5);
+  REQUIRE(buffer.size() == 3);
+  CHECK(buffer[0] == 5);
+  CHECK(buffer[1] == 6);
+  CHECK(buffer[2] == 7);
+}
+
 TEST_CASE("clears elements and calls destructors") {
   LifetimeTracker::reset();
 
@@ -363,4 +469,144 @@ TEST_CASE("clears elements and calls destructors") {
   REQUIRE(LifetimeTracker::copies == 0);
 }
 
+TEST_CASE("growing moves each element once") {
+  LifetimeTracker::reset();
+
+  {
+    nu::DynamicArray<LifetimeTracker> buffer;
+    for (I32 i = 0; i < 100; ++i) {
+      buffer.emplaceBack(i, i);
+    }
+
+    // Grew from 16 to 32, 64 and 128 elements.
+    CHECK(LifetimeTracker::moves == 16 + 32 + 64);
+    CHECK(LifetimeTracker::destroys == LifetimeTracker::moves);
+
+    for (I32 i = 0; i < 100; ++i) {
+      CHECK(buffer[i].a() == i);
+    }
+  }
+
+  CHECK(LifetimeTracker::creates + LifetimeTracker::moves == LifetimeTracker::destroys);
+}
+
+TEST_CASE("growing trivially relocatable elements") {
+  nu::DynamicArray<U32> buffer;
+  for (U32 i = 0; i < 100000; ++i) {
+    buffer.pushBack(i);
+  }
+
+  for (U32 i = 0; i < 100000; ++i) {
+    REQUIRE(buffer[i] == i);
+  }
+
+  nu::DynamicArray<nu::DynamicArray<U32>> nested;
+  for (U32 i = 0; i < 100; ++i) {
+    nested.emplaceBack(std::initializer_list<U32>{i, i + 1});
+  }
+  CHECK(nested[99][1] == 100);
+}
+
+TEST_CASE("resize constructs and destroys elements") {
+  LifetimeTracker::reset();
+
+  {
+    nu::DynamicArray<LifetimeTracker> buffer;
+    buffer.resize(10);
+    CHECK(LifetimeTracker::creates == 10);
+
+    buffer.resize(4);
+    CHECK(LifetimeTracker::destroys == 6);
+
+    buffer.resize(6, LifetimeTracker{1, 2});
+    CHECK(LifetimeTracker::copies == 2);
+    CHECK(buffer[5].a() == 1);
+  }
+
+  CHECK(LifetimeTracker::creates + LifetimeTracker::copies + LifetimeTracker::moves ==
+        LifetimeTracker::destroys);
+
+  nu::DynamicArray<I32> numbers;
+  numbers.resize(100);
+  for (auto number : numbers) {
+    CHECK(number == 0);
+  }
+}
+
+TEST_CASE("resize uninitialized") {
+  nu::DynamicArray<U8> buffer;
+  buffer.pushBack(1);
+  buffer.resize_uninitialized(1000);
+
+  CHECK(buffer.size() == 1000);
+  CHECK(buffer[0] == 1);
+
+  buffer.resize_uninitialized(1);
+  CHECK(buffer.size() == 1);
+  CHECK(buffer.capacity() >= 1000);
+}
+
+TEST_CASE("push back a range appends") {
+  nu::DynamicArray<I32> buffer = {1, 2};
+  I32 more[] = {3, 4, 5};
+  buffer.pushBack(more, more + 3);
+
+  REQUIRE(buffer.size() == 5);
+  for (I32 i = 0; i < 5; ++i) {
+    CHECK(buffer[i] == i + 1);
+  }
+}
+
+TEST_CASE("assignment destroys the old elements") {
+  LifetimeTracker::reset();
+
+  {
+    nu::DynamicArray<LifetimeTracker> first;
+    first.emplaceBack(1, 2);
+    first.emplaceBack(3, 4);
+
+    nu::DynamicArray<LifetimeTracker> second;
+    second.emplaceBack(5, 6);
+
+    second = first;
+    CHECK(LifetimeTracker::destroys == 1);
+    CHECK(second.size() == 2);
+
+    second = std::move(first);
+    CHECK(LifetimeTracker::destroys == 3);
+    CHECK(second[1].a() == 3);
+  }
+
+  CHECK(LifetimeTracker::creates + LifetimeTracker::copies == LifetimeTracker::destroys);
+}
+
+TEST_CASE("DynamicArray gets its memory from the allocator") {
+  AllocationCounts counts;
+
+  {
+    DynamicArray<I32, CountingAllocator> numbers{CountingAllocator{&counts}};
+    for (I32 i = 0; i < 100; ++i) {
+      numbers.pushBack(i);
+    }
+    CHECK(counts.allocations > 0);
+    CHECK(counts.bytesInUse == numbers.capacity() * sizeof(I32));
+
+    // Copies and moves take the allocator along.
+    auto copy = numbers;
+    CHECK(copy.allocator().counts() == &counts);
+    CHECK(counts.bytesInUse == (numbers.capacity() + copy.capacity()) * sizeof(I32));
+
+    auto moved = std::move(copy);
+    CHECK(moved.allocator().counts() == &counts);
+
+    DynamicArray<LifetimeTracker, CountingAllocator> trackers{CountingAllocator{&counts}};
+    for (I32 i = 0; i < 100; ++i) {
+      trackers.emplaceBack(i, i);
+    }
+    CHECK(trackers[99].a() == 99);
+  }
+
+  CHECK(counts.bytesInUse == 0);
+}
+
 }  // namespace nu
@@ -0,0 +1,201 @@
+#include <catch2/catch.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+
+#include "nucleus/containers/frozen_hash_map.h"
+#include "nucleus/streams/dynamic_buffer_output_stream.h"
+
+namespace nu {
+
+namespace {
+
+// Takes a limited number of bytes and drops the rest, like a full disk.
+class LimitedOutputStream : public OutputStream {
+public:
+  explicit LimitedOutputStream(MemSize limit) : OutputStream{Binary}, limit_{limit} {}
+
+  SizeType write(const void*, SizeType size) override {
+    SizeType written = std::min(size, limit_);
+    limit_ -= written;
+    return written;
+  }
+
+private:
+  MemSize limit_;
+};
+
+}  // namespace
+
+TEST_CASE("FrozenHashMap") {
+  DynamicBufferOutputStream stream;
+
+  SECTION("from a hash map") {
+    HashMap<U32, U64> map;
+    for (U32 i = 0; i < 10000; ++i) {
+      map.insert(i * 7, static_cast<U64>(i) << 32);
+    }
+
+    REQUIRE(FrozenHashMap<U32, U64>::write(&stream, map));
+
+    FrozenHashMap<U32, U64> frozen;
+    REQUIRE(frozen.load(ArrayView<U8>{stream.buffer()}));
+    CHECK(frozen.size() == 10000);
+
+    for (U32 i = 0; i < 70000; ++i) {
+      auto result = frozen.find(i);
+      REQUIRE(result.was_found() == (i % 7 == 0));
+      if (result.was_found()) {
+        CHECK(result.key() == i);
+        CHECK(result.value() == static_cast<U64>(i / 7) << 32);
+      }
+    }
+
+    MemSize count = 0;
+    for (auto& item : frozen) {
+      CHECK(map.find(item.key).value() == item.value);
+      ++count;
+    }
+    CHECK(count == 10000);
+  }
+
+  SECTION("from items") {
+    HashMapItem<I32, I32> items[] = {{1, 10}, {2, 20}, {3, 30}, {-4, 40}, {5, 50}};
+    REQUIRE(FrozenHashMap<I32, I32>::write(
+        &stream, ArrayView<HashMapItem<I32, I32>>{items, NU_ARRAY_SIZE(items)}));
+
+    FrozenHashMap<I32, I32> frozen;
+    REQUIRE(frozen.load(ArrayView<U8>{stream.buffer()}));
+    CHECK(frozen.size() == 5);
+    CHECK(frozen.find(-4).value() == 40);
+    CHECK(frozen.find(5).value() == 50);
+    CHECK(!frozen.contains_key(4));
+  }
+
+  SECTION("empty") {
+    REQUIRE(FrozenHashMap<I32, I32>::write(&stream, HashMap<I32, I32>{}));
+
+    FrozenHashMap<I32, I32> frozen;
+    REQUIRE(frozen.load(ArrayView<U8>{stream.buffer()}));
+    CHECK(frozen.empty());
+    CHECK(!frozen.contains_key(0));
+  }
+
+  SECTION("duplicate keys") {
+    HashMapItem<I32, I32> items[] = {{1, 10}, {1, 20}};
+    CHECK(!FrozenHashMap<I32, I32>::write(
+        &stream, ArrayView<HashMapItem<I32, I32>>{items, NU_ARRAY_SIZE(items)}));
+  }
+
+  SECTION("rejects invalid data") {
+    HashMap<I32, I32> map;
+    map.insert(1, 1);
+    REQUIRE(FrozenHashMap<I32, I32>::write(&stream, map));
+
+    FrozenHashMap<I32, I64> wrong_types;
+    CHECK(!wrong_types.load(ArrayView<U8>{stream.buffer()}));
+
+    FrozenHashMap<I32, I32> frozen;
+    CHECK(!frozen.load(ArrayView<U8>{stream.buffer().data(), 16}));
+    CHECK(!frozen.load(ArrayView<U8>{stream.buffer().data(), stream.buffer().size() - 1}));
+
+    U8 garbage[64] = {};
+    CHECK(!frozen.load(ArrayView<U8>{garbage, sizeof(garbage)}));
+  }
+
+  SECTION("fails on a short write") {
+    HashMap<I32, I32> map;
+    for (I32 i = 0; i < 100; ++i) {
+      map.insert(i, i);
+    }
+
+    // Stop in the header, in the pilots and in the entries.
+    for (MemSize limit : {MemSize{10}, MemSize{50}, MemSize{200}}) {
+      LimitedOutputStream limited{limit};
+      CHECK(!FrozenHashMap<I32, I32>::write(&limited, map));
+    }
+
+    LimitedOutputStream enough{1024 * 1024};
+    CHECK(FrozenHashMap<I32, I32>::write(&enough, map));
+  }
+
+  SECTION("rejects corrupt headers and pilots") {
+    HashMap<I32, I32> map;
+    map.insert(1, 10);
+    REQUIRE(FrozenHashMap<I32, I32>::write(&stream, map));
+
+    // Copy into memory that is aligned for the map.
+    const auto& buffer = stream.buffer();
+    DynamicArray<U64> storage;
+    storage.resize((buffer.size() + 7) / 8);
+    auto* bytes = reinterpret_cast<U8*>(storage.data());
+    std::memcpy(bytes, buffer.data(), buffer.size());
+    ArrayView<U8> data{bytes, buffer.size()};
+
+    FrozenHashMap<I32, I32> frozen;
+    REQUIRE(frozen.load(data));
+
+    detail::FrozenHashMapHeader header;
+    std::memcpy(&header, bytes, sizeof(header));
+
+    auto with_header = [&](const detail::FrozenHashMapHeader& changed) {
+      std::memcpy(bytes, &changed, sizeof(changed));
+      bool result = frozen.load(data);
+      std::memcpy(bytes, &header, sizeof(header));
+      return result;
+    };
+
+    // An offset so large that adding the size of the entries wraps around.
+    auto wrapping = header;
+    wrapping.entries_offset = ~U64{0} - 7;
+    CHECK(!with_header(wrapping));
+
+    auto too_many_entries = header;
+    too_many_entries.entry_count = 0xFFFFFFFF;
+    CHECK(!with_header(too_many_entries));
+
+    auto misaligned = header;
+    misaligned.entries_offset += 1;
+    misaligned.entry_count = 0;
+    CHECK(!with_header(misaligned));
+
+    // The only key has a bucket to itself, so its pilot points straight at its entry.
+    REQUIRE(header.bucket_count == 1);
+    U32 pilot;
+    std::memcpy(&pilot, bytes + sizeof(header), sizeof(pilot));
+    U32 out_of_bounds = 0x80000000 | header.entry_count;
+    std::memcpy(bytes + sizeof(header), &out_of_bounds, sizeof(out_of_bounds));
+    CHECK(!frozen.load(data));
+
+    std::memcpy(bytes + sizeof(header), &pilot, sizeof(pilot));
+    CHECK(frozen.load(data));
+  }
+
+  SECTION("writes padding as zeros") {
+    using ItemType = HashMapItem<U32, U64>;
+
+    // Fill the padding between the key and the value with garbage.
+    alignas(ItemType) U8 storage[sizeof(ItemType) * 3];
+    std::memset(storage, 0xAB, sizeof(storage));
+    auto* items = reinterpret_cast<ItemType*>(storage);
+    for (U32 i = 0; i < 3; ++i) {
+      items[i].key = i;
+      items[i].value = i * 100;
+    }
+
+    REQUIRE(FrozenHashMap<U32, U64>::write(&stream, ArrayView<ItemType>{items, 3}));
+
+    const auto& buffer = stream.buffer();
+    detail::FrozenHashMapHeader header;
+    std::memcpy(&header, buffer.data(), sizeof(header));
+    for (U32 i = 0; i < 3; ++i) {
+      MemSize entry = header.entries_offset + i * sizeof(ItemType);
+      for (MemSize offset = sizeof(U32); offset < offsetof(ItemType, value); ++offset) {
+        CHECK(buffer[entry + offset] == 0);
+      }
+    }
+  }
+}
+
+}  // namespace nu
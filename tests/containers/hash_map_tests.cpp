@@ -1,6 +1,13 @@
+#define CATCH_CONFIG_ENABLE_BENCHMARKING
 #include <catch2/catch.hpp>
 
+#include <string>
+
+#include "nucleus/containers/dynamic_array.h"
 #include "nucleus/containers/hash_map.h"
+#include "nucleus/memory/scoped_ptr.h"
+#include "nucleus/testing/counting_allocator.h"
+#include "nucleus/testing/lifetime_tracker.h"
 #include "nucleus/text/dynamic_string.h"
 
 namespace nu {
@@ -27,4 +34,263 @@ TEST_CASE("HashMap") {
 }
 #endif  // 0
 
+TEST_CASE("HashMap lookups") {
+  HashMap<DynamicString, I32> map;
+
+  map.insert(DynamicString{"one"}, 1);
+  map.insert(DynamicString{"two"}, 2);
+
+  SECTION("by key") {
+    CHECK(map.contains_key(DynamicString{"one"}));
+    CHECK(map.find(DynamicString{"two"}).value() == 2);
+    CHECK(!map.find(DynamicString{"three"}).was_found());
+  }
+
+  SECTION("by hash compatible type") {
+    CHECK(map.contains_key(StringView{"one"}));
+    CHECK(!map.contains_key(StringView{"three"}));
+
+    auto result = map.find(StringView{"two"});
+    REQUIRE(result.was_found());
+    CHECK(result.key() == StringView{"two"});
+    CHECK(result.value() == 2);
+
+    CHECK(map.remove(StringView{"one"}));
+    CHECK(!map.remove(StringView{"one"}));
+    CHECK(map.size() == 1);
+  }
+
+  SECTION("with precomputed hash") {
+    StringView key{"three"};
+    auto hash = Hash<StringView>::hashed(key);
+
+    CHECK(!map.find_with_hash(hash, key).was_found());
+
+    auto insert_result = map.insert_with_hash(hash, DynamicString{key}, 3);
+    CHECK(insert_result.is_new());
+
+    auto find_result = map.find_with_hash(hash, key);
+    REQUIRE(find_result.was_found());
+    CHECK(find_result.value() == 3);
+
+    CHECK(map.remove_with_hash(hash, key));
+    CHECK(!map.contains_key(key));
+  }
+}
+
+TEST_CASE("HashMap batched lookups") {
+  HashMap<I32, I32> map;
+  for (I32 i = 0; i < 1000; ++i) {
+    map.insert(i * 3, i);
+  }
+
+  DynamicArray<I32> keys;
+  for (I32 i = 0; i < 100; ++i) {
+    keys.pushBack(i);
+  }
+
+  MemSize found = 0;
+  map.find_many(ArrayView<I32>{keys}, [&](MemSize index, HashMap<I32, I32>::FindResult result) {
+    REQUIRE(result.was_found() == (keys[index] % 3 == 0));
+    if (result.was_found()) {
+      CHECK(result.key() == keys[index]);
+      CHECK(result.value() == keys[index] / 3);
+      ++found;
+    }
+  });
+  CHECK(found == 34);
+
+  SECTION("by hash compatible type") {
+    HashMap<DynamicString, I32> names;
+    names.insert(DynamicString{"one"}, 1);
+    names.insert(DynamicString{"two"}, 2);
+
+    StringView lookups[] = {"two", "three", "one"};
+    I32 values[] = {0, 0, 0};
+    names.find_many(ArrayView<StringView>{lookups, NU_ARRAY_SIZE(lookups)},
+                    [&](MemSize index, HashMap<DynamicString, I32>::FindResult result) {
+                      values[index] = result.was_found() ? result.value() : -1;
+                    });
+    CHECK(values[0] == 2);
+    CHECK(values[1] == -1);
+    CHECK(values[2] == 1);
+  }
+}
+
+TEST_CASE("HashMap sizing and copies") {
+  HashMap<DynamicString, I32> map{{DynamicString{"one"}, 1}, {DynamicString{"two"}, 2}};
+  CHECK(map.size() == 2);
+  CHECK(map.find(StringView{"two"}).value() == 2);
+
+  map.reserve(100);
+  auto capacity = map.capacity();
+
+  HashMap<DynamicString, I32> copy{map};
+  CHECK(copy.capacity() == capacity);
+  CHECK(copy.size() == 2);
+  CHECK(copy.find(StringView{"one"}).value() == 1);
+
+  copy.insert(DynamicString{"one"}, 10);
+  CHECK(map.find(StringView{"one"}).value() == 1);
+}
+
+TEST_CASE("HashMap in place insertion") {
+  using testing::LifetimeTracker;
+
+  SECTION("try_emplace constructs nothing for an existing key") {
+    HashMap<I32, LifetimeTracker> map;
+
+    LifetimeTracker::reset();
+    auto first = map.try_emplace(1, 10, 20);
+    CHECK(first.is_new());
+    CHECK(first.value().a() == 10);
+    CHECK(LifetimeTracker::creates == 1);
+    CHECK(LifetimeTracker::copies == 0);
+    CHECK(LifetimeTracker::moves == 0);
+
+    auto second = map.try_emplace(1, 30, 40);
+    CHECK(!second.is_new());
+    CHECK(second.value().a() == 10);
+    CHECK(LifetimeTracker::creates == 1);
+  }
+
+  SECTION("insert_or_assign") {
+    HashMap<I32, LifetimeTracker> map;
+
+    CHECK(map.insert_or_assign(1, LifetimeTracker{1, 2}).is_new());
+
+    LifetimeTracker::reset();
+    auto result = map.insert_or_assign(1, LifetimeTracker{3, 4});
+    CHECK(!result.is_new());
+    CHECK(result.value().a() == 3);
+    CHECK(map.size() == 1);
+    CHECK(LifetimeTracker::moves == 1);
+    CHECK(LifetimeTracker::copies == 0);
+  }
+
+  SECTION("emplace keeps the existing item") {
+    HashMap<I32, I32> map;
+
+    CHECK(map.emplace(1, 10).is_new());
+    auto result = map.emplace(1, 20);
+    CHECK(!result.is_new());
+    CHECK(result.value() == 10);
+  }
+
+  SECTION("move-only values") {
+    HashMap<I32, ScopedPtr<I32>> map;
+
+    for (I32 i = 0; i < 100; ++i) {
+      CHECK(map.try_emplace(i, new I32{i}).is_new());
+    }
+    CHECK(map.insert(5, ScopedPtr<I32>{new I32{50}}).value().get() != nullptr);
+    CHECK(map.insert_or_assign(6, ScopedPtr<I32>{new I32{60}}).key() == 6);
+
+    CHECK(map.size() == 100);
+    CHECK(*map.find(5).value() == 50);
+    CHECK(*map.find(6).value() == 60);
+    CHECK(*map.find(99).value() == 99);
+
+    CHECK(map.remove(5));
+    CHECK(!map.contains_key(5));
+  }
+
+  SECTION("move-only keys") {
+    HashMap<DynamicString, I32> map;
+
+    DynamicString key{"moved"};
+    map.try_emplace(std::move(key), 1);
+    CHECK(key.empty());
+    CHECK(map.find(StringView{"moved"}).value() == 1);
+  }
+
+  SECTION("hash compatible keys are converted only for new items") {
+    HashMap<DynamicString, I32> map;
+
+    auto first = map.try_emplace(StringView{"one"}, 1);
+    CHECK(first.is_new());
+    CHECK(first.key() == StringView{"one"});
+
+    auto second = map.try_emplace(StringView{"one"}, 2);
+    CHECK(!second.is_new());
+    CHECK(second.value() == 1);
+
+    CHECK(!map.insert_or_assign(StringView{"one"}, 3).is_new());
+    CHECK(map.insert_or_assign(StringView{"two"}, 4).is_new());
+    CHECK(map.find(StringView{"one"}).value() == 3);
+    CHECK(map.find(StringView{"two"}).value() == 4);
+  }
+}
+
+TEST_CASE("HashMap with seeded hashes") {
+  HashMap<DynamicString, I32, GroupProbing, SeededHash> map;
+
+  for (I32 i = 0; i < 100; ++i) {
+    map.insert(DynamicString{std::to_string(i).c_str()}, i);
+  }
+
+  CHECK(map.size() == 100);
+  CHECK(map.find(DynamicString{"42"}).value() == 42);
+  CHECK(map.find(StringView{"43"}).value() == 43);
+  CHECK(!map.contains_key(StringView{"100"}));
+  CHECK(map.remove(StringView{"42"}));
+  CHECK(!map.contains_key(DynamicString{"42"}));
+}
+
+TEST_CASE("HashMap gets its memory from the allocator") {
+  using testing::AllocationCounts;
+  using testing::CountingAllocator;
+  using Map = HashMap<I32, I32, GroupProbing, Hash, CountingAllocator>;
+
+  AllocationCounts counts;
+
+  {
+    Map map{CountingAllocator{&counts}};
+    for (I32 i = 0; i < 1000; ++i) {
+      map.insert(i, i * 2);
+    }
+    CHECK(map.find(500).value() == 1000);
+    CHECK(counts.allocations > 1);
+    CHECK(counts.deallocations == counts.allocations - 1);
+
+    Map copy{map};
+    CHECK(copy.find(999).value() == 1998);
+    CHECK(copy.allocator().counts() == &counts);
+  }
+
+  CHECK(counts.allocations == counts.deallocations);
+  CHECK(counts.bytesInUse == 0);
+}
+
+// Run with `nucleus_tests [benchmark]`.
+TEST_CASE("HashMap seeded hash throughput", "[.][benchmark]") {
+  auto keys = DynamicArray<DynamicString>::withInitialCapacity(10000);
+  for (I32 i = 0; i < 10000; ++i) {
+    keys.emplaceBack(("client-supplied-key-" + std::to_string(i)).c_str());
+  }
+
+  HashMap<DynamicString, I32> unseeded;
+  HashMap<DynamicString, I32, GroupProbing, SeededHash> seeded;
+  for (MemSize i = 0; i < keys.size(); ++i) {
+    unseeded.insert(keys[i], static_cast<I32>(i));
+    seeded.insert(keys[i], static_cast<I32>(i));
+  }
+
+  BENCHMARK("unseeded lookups") {
+    I32 sum = 0;
+    for (auto& key : keys) {
+      sum += unseeded.find(key).value();
+    }
+    return sum;
+  };
+
+  BENCHMARK("seeded lookups") {
+    I32 sum = 0;
+    for (auto& key : keys) {
+      sum += seeded.find(key).value();
+    }
+    return sum;
+  };
+}
+
 }  // namespace nu
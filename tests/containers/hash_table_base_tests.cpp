@@ -1,27 +1,75 @@
 #include <catch2/catch.hpp>
 
 #include "nucleus/containers/hash_table_base.h"
+#include "nucleus/profiling.h"
 #include "nucleus/testing/lifetime_tracker.h"
 
 namespace nu {
 
 using testing::LifetimeTracker;
 
-class HashTableTest : public HashTableBase<LifetimeTracker> {
+template <typename ProbingPolicy, typename Traits = DefaultHashTableBaseTraits<LifetimeTracker>>
+class HashTableTest : public HashTableBase<LifetimeTracker, Traits, ProbingPolicy> {
 public:
+  using Base = HashTableBase<LifetimeTracker, Traits, ProbingPolicy>;
+  using Bucket = typename Base::Bucket;
+
   template <typename Predicate>
-  Bucket* find_bucket_for_reading(HashedValue hash, Predicate predicate) const {
-    return HashTableBase::find_bucket_for_reading(hash, predicate);
+  Bucket find_bucket_for_reading(HashedValue hash, Predicate predicate) const {
+    return Base::find_bucket_for_reading(hash, predicate);
   }
 
   template <typename Predicate>
-  Bucket* find_bucket_for_writing(HashedValue hash, Predicate predicate) {
-    return HashTableBase::find_bucket_for_writing(hash, predicate);
+  Bucket find_bucket_for_writing(HashedValue hash, Predicate predicate) {
+    return Base::find_bucket_for_writing(hash, predicate);
+  }
+
+  void insert(const LifetimeTracker& item) {
+    auto bucket = find_bucket_for_writing(Traits::hashed(item), [&](const LifetimeTracker& t) {
+      return t == item;
+    });
+    if (!bucket.is_used()) {
+      ++this->size_;
+    }
+    bucket.set(item);
+  }
+
+  bool remove(const LifetimeTracker& item) {
+    auto bucket = find_bucket_for_reading(Traits::hashed(item), [&](const LifetimeTracker& t) {
+      return t == item;
+    });
+    if (!bucket) {
+      return false;
+    }
+    this->erase_bucket(bucket);
+    return true;
+  }
+
+  MemSize tombstones() const {
+    return this->deleted_;
+  }
+
+  bool contains(const LifetimeTracker& item) const {
+    return static_cast<bool>(
+        find_bucket_for_reading(Traits::hashed(item), [&](const LifetimeTracker& t) {
+          return t == item;
+        }));
   }
 };
 
-TEST_CASE("HashTableBase") {
-  HashTableTest htb;
+// Gives every item the same 7-bit hash fragment, so every full control byte matches.
+struct SameFragmentTraits {
+  static HashedValue hashed(const LifetimeTracker& item) {
+    return static_cast<HashedValue>(item.a()) << 7;
+  }
+
+  static bool equals(const LifetimeTracker& left, const LifetimeTracker& right) {
+    return left == right;
+  }
+};
+
+TEMPLATE_TEST_CASE("HashTableBase", "", GroupProbing, RobinHoodProbing) {
+  HashTableTest<TestType> htb;
 
   SECTION("basic") {
     CHECK(htb.empty());
@@ -30,22 +78,316 @@ TEST_CASE("HashTableBase") {
 
   SECTION("find bucket on empty table") {
     HashedValue hash = 0;
-    auto* bucket = htb.find_bucket_for_reading(hash, [](const LifetimeTracker&) {
+    auto bucket = htb.find_bucket_for_reading(hash, [](const LifetimeTracker&) {
       return false;
     });
 
-    CHECK(bucket == nullptr);
+    CHECK(!bucket);
   }
 
   SECTION("insert single item") {
     HashedValue hash = 0;
-    auto* bucket = htb.find_bucket_for_writing(hash, [](const LifetimeTracker&) {
+    auto bucket = htb.find_bucket_for_writing(hash, [](const LifetimeTracker&) {
       return false;
     });
 
     CHECK(htb.capacity() > 0);
 
-    CHECK(bucket != nullptr);
+    CHECK(bucket);
+  }
+
+  SECTION("items sharing a hash fragment") {
+    HashTableTest<TestType, SameFragmentTraits> same;
+
+    for (I32 i = 0; i < 100; ++i) {
+      same.insert({i, 0});
+    }
+
+    CHECK(same.size() == 100);
+
+    for (I32 i = 0; i < 100; ++i) {
+      CHECK(same.contains({i, 0}));
+    }
+    CHECK(!same.contains({100, 0}));
+  }
+
+  SECTION("negative lookups") {
+    for (I32 i = 0; i < 100; ++i) {
+      htb.insert({i, 0});
+    }
+
+    for (I32 i = 100; i < 200; ++i) {
+      CHECK(!htb.contains({i, 0}));
+    }
+  }
+
+  SECTION("remove") {
+    for (I32 i = 0; i < 1000; ++i) {
+      htb.insert({i, 0});
+    }
+
+    for (I32 i = 0; i < 1000; i += 2) {
+      CHECK(htb.remove({i, 0}));
+    }
+    CHECK(htb.size() == 500);
+
+    for (I32 i = 0; i < 1000; ++i) {
+      CHECK(htb.contains({i, 0}) == (i % 2 == 1));
+    }
+  }
+
+  SECTION("high load") {
+    htb.set_max_load_factor(1.0f);
+
+    for (I32 i = 0; i < 256; ++i) {
+      htb.insert({i, 0});
+    }
+    CHECK(htb.capacity() == 256);
+
+    for (I32 i = 0; i < 256; ++i) {
+      CHECK(htb.contains({i, 0}));
+    }
+    CHECK(!htb.contains({256, 0}));
+  }
+
+  SECTION("iterate sparse table") {
+    for (I32 i = 0; i < 1000; ++i) {
+      htb.insert({i, 0});
+    }
+    for (I32 i = 0; i < 1000; ++i) {
+      if (i % 100 != 0) {
+        htb.remove({i, 0});
+      }
+    }
+
+    I32 sum = 0;
+    MemSize count = 0;
+    for (auto& item : htb) {
+      sum += item.a();
+      ++count;
+    }
+    CHECK(count == 10);
+    CHECK(sum == 4500);
+  }
+
+  SECTION("erase while iterating") {
+    for (I32 i = 0; i < 1000; ++i) {
+      htb.insert({i, 0});
+    }
+
+    for (auto it = htb.begin(); it != htb.end();) {
+      if ((*it).a() % 2 == 0) {
+        it = htb.erase(it);
+      } else {
+        ++it;
+      }
+    }
+
+    CHECK(htb.size() == 500);
+    for (I32 i = 0; i < 1000; ++i) {
+      CHECK(htb.contains({i, 0}) == (i % 2 == 1));
+    }
+  }
+}
+
+// Every item has the same hash, so probe distances go past what fits in a control byte.
+struct CollidingTraits {
+  static HashedValue hashed(const LifetimeTracker&) {
+    return 0;
+  }
+
+  static bool equals(const LifetimeTracker& left, const LifetimeTracker& right) {
+    return left == right;
+  }
+};
+
+TEST_CASE("HashTableBase Robin Hood long probe distances") {
+  HashTableTest<RobinHoodProbing, CollidingTraits> htb;
+
+  for (I32 i = 0; i < 400; ++i) {
+    htb.insert({i, 0});
+  }
+
+  for (I32 i = 0; i < 400; i += 3) {
+    CHECK(htb.remove({i, 0}));
+  }
+
+  for (I32 i = 0; i < 400; ++i) {
+    CHECK(htb.contains({i, 0}) == (i % 3 != 0));
+  }
+}
+
+// Every item has its home in the second to last slot of tables with up to 4096 slots, so most of
+// them wrap around to the start of the table.
+struct WrappingTraits {
+  static HashedValue hashed(const LifetimeTracker&) {
+    static const HashedValue hash = [] {
+      HashedValue result = 0;
+      while ((detail::fibonacci_index(result) & 0xFFF) != 0xFFE) {
+        ++result;
+      }
+      return result;
+    }();
+    return hash;
+  }
+
+  static bool equals(const LifetimeTracker& left, const LifetimeTracker& right) {
+    return left == right;
+  }
+};
+
+TEST_CASE("HashTableBase Robin Hood erase while iterating over wrapped items") {
+  HashTableTest<RobinHoodProbing, WrappingTraits> htb;
+
+  for (I32 i = 0; i < 10; ++i) {
+    htb.insert({i, 0});
+  }
+
+  // Erasing the items at the end shifts the wrapped items at the start of the table, which were
+  // visited first, back to the end.
+  MemSize visits[10] = {};
+  for (auto it = htb.begin(); it != htb.end();) {
+    I32 a = (*it).a();
+    ++visits[a];
+    if (a % 2 == 0) {
+      it = htb.erase(it);
+    } else {
+      ++it;
+    }
+  }
+
+  for (I32 i = 0; i < 10; ++i) {
+    CHECK(visits[i] == 1);
+    CHECK(htb.contains({i, 0}) == (i % 2 == 1));
+  }
+}
+
+TEST_CASE("HashTableBase Robin Hood leaves no tombstones") {
+  HashTableTest<RobinHoodProbing> htb;
+
+  for (I32 i = 0; i < 1000; ++i) {
+    htb.insert({i, 0});
+  }
+
+  for (I32 i = 0; i < 1000; i += 3) {
+    CHECK(htb.remove({i, 0}));
+  }
+
+  CHECK(htb.tombstones() == 0);
+  for (I32 i = 0; i < 1000; ++i) {
+    CHECK(htb.contains({i, 0}) == (i % 3 != 0));
+  }
+}
+
+TEMPLATE_TEST_CASE("HashTableBase statistics", "", GroupProbing, RobinHoodProbing) {
+  HashTableTest<TestType> htb;
+
+  SECTION("empty") {
+    auto statistics = htb.statistics();
+    CHECK(statistics.size == 0);
+    CHECK(statistics.capacity == 0);
+    CHECK(statistics.load_factor == 0.0f);
+    CHECK(statistics.max_hit_probe_length == 0);
+    CHECK(statistics.max_cluster_size == 0);
+  }
+
+  SECTION("items") {
+    for (I32 i = 0; i < 1000; ++i) {
+      htb.insert({i, 0});
+    }
+    for (I32 i = 0; i < 1000; i += 4) {
+      htb.remove({i, 0});
+    }
+
+    auto statistics = htb.statistics();
+    CHECK(statistics.size == 750);
+    CHECK(statistics.capacity == htb.capacity());
+    CHECK(statistics.tombstones == htb.tombstones());
+    CHECK(statistics.load_factor == Approx(750.0f / static_cast<F32>(htb.capacity())));
+
+    MemSize hits = 0;
+    for (auto count : statistics.hit_probe_lengths) {
+      hits += count;
+    }
+    CHECK(hits == 750);
+    CHECK(statistics.average_hit_probe_length >= 1.0);
+    CHECK(statistics.average_hit_probe_length <= statistics.max_hit_probe_length);
+
+    MemSize misses = 0;
+    for (auto count : statistics.miss_probe_lengths) {
+      misses += count;
+    }
+    CHECK(misses == htb.capacity() / TestType::PROBE_START_STRIDE);
+    CHECK(statistics.average_miss_probe_length >= 1.0);
+    CHECK(statistics.average_miss_probe_length <= statistics.max_miss_probe_length);
+
+    MemSize clusters = 0;
+    for (auto count : statistics.cluster_sizes) {
+      clusters += count;
+    }
+    CHECK(clusters > 0);
+    CHECK(statistics.max_cluster_size >= 1);
+    CHECK(statistics.max_cluster_size <= 750 + statistics.tombstones);
+  }
+
+  SECTION("colliding hashes") {
+    HashTableTest<TestType, CollidingTraits> colliding;
+    for (I32 i = 0; i < 100; ++i) {
+      colliding.insert({i, 0});
+    }
+
+    // Every item is on the same probe sequence.  Robin Hood keeps them next to each other, while
+    // group probing fills whole groups scattered over the table.
+    auto statistics = colliding.statistics();
+    if constexpr (std::is_same_v<TestType, RobinHoodProbing>) {
+      CHECK(statistics.max_hit_probe_length == 100);
+      CHECK(statistics.max_cluster_size >= 100);
+      CHECK(statistics.cluster_sizes[6] + statistics.cluster_sizes[7] == 1);
+    } else {
+      CHECK(statistics.max_hit_probe_length == 7);
+      CHECK(statistics.max_cluster_size >= detail::Group::WIDTH);
+    }
+  }
+
+  SECTION("large tables") {
+    HashTableTest<TestType, CollidingTraits> colliding;
+    for (I32 i = 0; i < 1200; ++i) {
+      colliding.insert({i, 0});
+    }
+    colliding.reserve(HashTableStatistics::MAX_MISS_SAMPLES * TestType::PROBE_START_STRIDE * 2);
+
+    // Misses are only sampled and no probe is followed past the limit.
+    auto statistics = colliding.statistics();
+    MemSize misses = 0;
+    for (auto count : statistics.miss_probe_lengths) {
+      misses += count;
+    }
+    CHECK(misses == HashTableStatistics::MAX_MISS_SAMPLES);
+    CHECK(statistics.max_hit_probe_length <= HashTableStatistics::MAX_PROBE_LENGTH);
+    CHECK(statistics.max_miss_probe_length <= HashTableStatistics::MAX_PROBE_LENGTH);
+    if constexpr (std::is_same_v<TestType, RobinHoodProbing>) {
+      CHECK(statistics.max_hit_probe_length == HashTableStatistics::MAX_PROBE_LENGTH);
+    }
+  }
+
+  SECTION("export to profiling") {
+    for (I32 i = 0; i < 100; ++i) {
+      htb.insert({i, 0});
+    }
+
+    // Without profile metrics there is nowhere to export to.
+    htb.statistics().export_to_profiling("table");
+
+    Profiling profiling;
+    htb.statistics().export_to_profiling("table");
+
+    auto& counters = detail::getCurrentProfileMetrics()->counters();
+    auto size = counters.find(DynamicString{"table.size"});
+    REQUIRE(size.was_found());
+    CHECK(size.value() == 100.0);
+    CHECK(counters.contains_key(DynamicString{"table.max_hit_probe_length"}));
+    CHECK(counters.contains_key(DynamicString{"table.hit_probe_lengths.1"}));
+    CHECK(counters.contains_key(DynamicString{"table.cluster_sizes.64"}));
   }
 }
 
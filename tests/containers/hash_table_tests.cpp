@@ -1,7 +1,9 @@
 #include <catch2/catch.hpp>
 
+#include "nucleus/containers/dynamic_array.h"
 #include "nucleus/containers/hash_table.h"
 #include "nucleus/testing/lifetime_tracker.h"
+#include "nucleus/text/dynamic_string.h"
 
 namespace nu {
 
@@ -123,6 +125,219 @@ TEST_CASE("HashTable") {
     CHECK(first.size() == second.size());
     CHECK(first.capacity() == second.capacity());
   }
+
+  SECTION("max load factor") {
+    HashTable<I32> t;
+
+    for (I32 i = 0; i < 1000; ++i) {
+      t.insert(i);
+      CHECK(static_cast<F32>(t.size()) <= static_cast<F32>(t.capacity()) * t.max_load_factor());
+    }
+
+    t.set_max_load_factor(0.5f);
+    t.insert(1000);
+    CHECK(t.size() * 2 <= t.capacity());
+
+    for (I32 i = 0; i <= 1000; ++i) {
+      CHECK(t.contains(i));
+    }
+  }
+
+  SECTION("insert and remove churn") {
+    HashTable<I32> t;
+
+    const I32 live_count = 100;
+    for (I32 i = 0; i < live_count; ++i) {
+      t.insert(i);
+    }
+
+    // Tombstones are cleaned up, so the table stops growing while its size stays the same.
+    MemSize capacity = 0;
+    for (I32 i = 0; i < 100000; ++i) {
+      CHECK(t.remove(i));
+      CHECK(t.insert(i + live_count).is_new());
+
+      if (i == 1000) {
+        capacity = t.capacity();
+      }
+    }
+
+    CHECK(t.size() == live_count);
+    CHECK(t.capacity() == capacity);
+
+    for (I32 i = 100000; i < 100000 + live_count; ++i) {
+      CHECK(t.contains(i));
+    }
+    CHECK(!t.contains(0));
+  }
+}
+
+TEST_CASE("HashTable with Robin Hood probing") {
+  HashTable<I32, RobinHoodProbing> t;
+
+  for (I32 i = 0; i < 1000; ++i) {
+    CHECK(t.insert(i).is_new());
+  }
+  CHECK(!t.insert(10).is_new());
+
+  for (I32 i = 0; i < 1000; i += 2) {
+    CHECK(t.remove(i));
+  }
+
+  CHECK(t.size() == 500);
+  for (I32 i = 0; i < 1000; ++i) {
+    CHECK(t.contains(i) == (i % 2 == 1));
+  }
+}
+
+TEST_CASE("HashTable lookups by hash compatible type") {
+  HashTable<DynamicString> t;
+
+  t.insert(DynamicString{"first"});
+  t.insert_with_hash(Hash<StringView>::hashed("second"), DynamicString{"second"});
+
+  CHECK(t.contains(StringView{"first"}));
+  CHECK(t.find(StringView{"second"}).was_found());
+  CHECK(t.find_with_hash(Hash<StringView>::hashed("second"), StringView{"second"}).was_found());
+  CHECK(!t.contains(StringView{"third"}));
+
+  CHECK(t.remove(StringView{"first"}));
+  CHECK(!t.contains(DynamicString{"first"}));
+  CHECK(t.size() == 1);
+}
+
+TEST_CASE("HashTable batched lookups") {
+  HashTable<I32> t;
+  for (I32 i = 0; i < 100; i += 2) {
+    t.insert(i);
+  }
+
+  // More than a single batch, with a partial batch at the end.
+  DynamicArray<I32> items;
+  for (I32 i = 0; i < 50; ++i) {
+    items.pushBack(i);
+  }
+
+  MemSize calls = 0;
+  t.contains_many(ArrayView<I32>{items}, [&](MemSize index, bool found) {
+    CHECK(index == calls);
+    CHECK(found == (items[index] % 2 == 0));
+    ++calls;
+  });
+  CHECK(calls == items.size());
+
+  t.find_many(ArrayView<I32>{items}, [&](MemSize index, HashTable<I32>::FindResult result) {
+    if (result.was_found()) {
+      CHECK(result.item() == items[index]);
+    }
+  });
+
+  HashTable<I32> empty;
+  empty.contains_many(ArrayView<I32>{items}, [](MemSize, bool found) {
+    CHECK(!found);
+  });
+}
+
+TEST_CASE("HashTable sizing and copies") {
+  SECTION("reserve") {
+    HashTable<I32> t;
+    t.reserve(1000);
+
+    auto capacity = t.capacity();
+    CHECK(capacity * t.max_load_factor() >= 1000);
+
+    for (I32 i = 0; i < 1000; ++i) {
+      t.insert(i);
+    }
+    CHECK(t.capacity() == capacity);
+
+    // Reserving less than what is there does nothing.
+    t.reserve(10);
+    CHECK(t.capacity() == capacity);
+  }
+
+  SECTION("construct from items") {
+    HashTable<I32> t{1, 2, 3, 2};
+    CHECK(t.size() == 3);
+    CHECK(t.contains(1));
+    CHECK(t.contains(3));
+
+    DynamicArray<I32> items;
+    for (I32 i = 0; i < 500; ++i) {
+      items.pushBack(i);
+    }
+
+    HashTable<I32> reserved;
+    reserved.reserve(items.size());
+
+    HashTable<I32> from_items{ArrayView<I32>{items}};
+    CHECK(from_items.size() == 500);
+    CHECK(from_items.capacity() == reserved.capacity());
+  }
+
+  SECTION("copies keep the layout") {
+    HashTable<I32> t;
+    for (I32 i = 0; i < 100; ++i) {
+      t.insert(i);
+    }
+    t.remove(50);
+
+    HashTable<I32> copy{t};
+    CHECK(copy.size() == t.size());
+    CHECK(copy.capacity() == t.capacity());
+
+    auto it = t.begin();
+    for (auto item : copy) {
+      CHECK(item == *it);
+      ++it;
+    }
+
+    copy.insert(1000);
+    CHECK(!t.contains(1000));
+
+    t = copy;
+    CHECK(t.contains(1000));
+    CHECK(t.size() == 100);
+  }
+
+  SECTION("copies items that are not trivially copyable") {
+    LifetimeTracker::reset();
+    {
+      HashTable<LifetimeTracker> t;
+      for (I32 i = 0; i < 10; ++i) {
+        t.insert(LifetimeTracker{i, i});
+      }
+
+      auto copies = LifetimeTracker::copies;
+      HashTable<LifetimeTracker> copy = t;
+      CHECK(LifetimeTracker::copies == copies + 10);
+      CHECK(copy.contains(LifetimeTracker{5, 5}));
+    }
+    CHECK(LifetimeTracker::creates + LifetimeTracker::copies + LifetimeTracker::moves ==
+          LifetimeTracker::destroys);
+  }
+}
+
+TEST_CASE("HashTable erase while iterating") {
+  HashTable<I32> t;
+  for (I32 i = 0; i < 1000; ++i) {
+    t.insert(i);
+  }
+
+  MemSize visited = 0;
+  for (auto it = t.begin(); it != t.end();) {
+    ++visited;
+    if (*it % 3 == 0) {
+      it = t.erase(it);
+    } else {
+      ++it;
+    }
+  }
+
+  CHECK(visited == 1000);
+  CHECK(t.size() == 666);
+  CHECK(!t.contains(999));
+  CHECK(t.contains(998));
 }
 
 }  // namespace nu
@@ -0,0 +1,234 @@
+#include <catch2/catch.hpp>
+
+#include "nucleus/containers/inline_dynamic_array.h"
+#include "nucleus/testing/counting_allocator.h"
+#include "nucleus/testing/lifetime_tracker.h"
+
+namespace nu {
+
+using testing::AllocationCounts;
+using testing::CountingAllocator;
+using testing::LifetimeTracker;
+
+TEST_CASE("InlineDynamicArray construct") {
+  SECTION("default") {
+    InlineDynamicArray<I32, 4> a;
+
+    CHECK(a.size() == 0);
+    CHECK(a.empty());
+    CHECK(a.capacity() == 4);
+    CHECK(a.isInline());
+  }
+
+  SECTION("initializer list") {
+    InlineDynamicArray<I32, 4> a = {10, 20, 30};
+
+    REQUIRE(a.size() == 3);
+    CHECK(a.isInline());
+    CHECK(a[0] == 10);
+    CHECK(a[1] == 20);
+    CHECK(a[2] == 30);
+  }
+
+  SECTION("more elements than fit inline") {
+    InlineDynamicArray<I32, 2> a = {10, 20, 30};
+
+    REQUIRE(a.size() == 3);
+    CHECK(!a.isInline());
+    CHECK(a[2] == 30);
+  }
+
+  SECTION("copy") {
+    InlineDynamicArray<I32, 4> a = {10, 20, 30};
+    InlineDynamicArray<I32, 4> b{a};
+
+    REQUIRE(b.size() == 3);
+    CHECK(b[0] == 10);
+    CHECK(b[2] == 30);
+    CHECK(a.size() == 3);
+  }
+}
+
+TEST_CASE("InlineDynamicArray stays inline until it is full") {
+  InlineDynamicArray<I32, 8> a;
+  for (I32 i = 0; i < 8; ++i) {
+    a.pushBack(i);
+  }
+
+  CHECK(a.isInline());
+  CHECK(a.capacity() == 8);
+
+  a.pushBack(8);
+
+  CHECK(!a.isInline());
+  CHECK(a.capacity() >= 9);
+  for (I32 i = 0; i < 9; ++i) {
+    CHECK(a[i] == i);
+  }
+
+  // Clearing frees the memory, so the array is inline again.
+  a.clear();
+  CHECK(a.isInline());
+  CHECK(a.capacity() == 8);
+}
+
+TEST_CASE("InlineDynamicArray spills non-trivial elements to the heap") {
+  LifetimeTracker::reset();
+
+  {
+    InlineDynamicArray<LifetimeTracker, 4> a;
+    for (I32 i = 0; i < 100; ++i) {
+      a.emplaceBack(i, i);
+    }
+
+    // Moved out of the inline storage into 16 elements, then grew to 32, 64 and 128 elements.
+    CHECK(LifetimeTracker::moves == 4 + 16 + 32 + 64);
+    CHECK(LifetimeTracker::copies == 0);
+
+    for (I32 i = 0; i < 100; ++i) {
+      CHECK(a[i].a() == i);
+    }
+  }
+
+  CHECK(LifetimeTracker::creates + LifetimeTracker::moves == LifetimeTracker::destroys);
+}
+
+TEST_CASE("InlineDynamicArray move") {
+  LifetimeTracker::reset();
+
+  SECTION("inline elements are moved one by one") {
+    {
+      InlineDynamicArray<LifetimeTracker, 4> a;
+      a.emplaceBack(1, 2);
+      a.emplaceBack(3, 4);
+
+      InlineDynamicArray<LifetimeTracker, 4> b{std::move(a)};
+
+      CHECK(a.empty());
+      REQUIRE(b.size() == 2);
+      CHECK(b[1].a() == 3);
+      CHECK(LifetimeTracker::moves == 2);
+    }
+
+    CHECK(LifetimeTracker::creates + LifetimeTracker::moves == LifetimeTracker::destroys);
+  }
+
+  SECTION("allocated elements are not touched") {
+    {
+      InlineDynamicArray<LifetimeTracker, 1> a;
+      a.emplaceBack(1, 2);
+      a.emplaceBack(3, 4);
+      auto moves = LifetimeTracker::moves;
+      auto* data = a.data();
+
+      InlineDynamicArray<LifetimeTracker, 1> b;
+      b.emplaceBack(5, 6);
+      b = std::move(a);
+
+      CHECK(a.empty());
+      CHECK(a.isInline());
+      CHECK(b.data() == data);
+      CHECK(LifetimeTracker::moves == moves);
+      REQUIRE(b.size() == 2);
+      CHECK(b[0].a() == 1);
+    }
+
+    CHECK(LifetimeTracker::creates + LifetimeTracker::moves == LifetimeTracker::destroys);
+  }
+}
+
+TEST_CASE("InlineDynamicArray swap") {
+  InlineDynamicArray<I32, 4> small = {1, 2};
+  InlineDynamicArray<I32, 4> large = {10, 20, 30, 40, 50};
+
+  small.swap(large);
+
+  REQUIRE(small.size() == 5);
+  REQUIRE(large.size() == 2);
+  CHECK(!small.isInline());
+  CHECK(large.isInline());
+  CHECK(small[4] == 50);
+  CHECK(large[1] == 2);
+
+  InlineDynamicArray<I32, 4> empty;
+  large.swap(empty);
+  CHECK(large.empty());
+  REQUIRE(empty.size() == 2);
+  CHECK(empty[0] == 1);
+}
+
+TEST_CASE("InlineDynamicArray remove") {
+  LifetimeTracker::reset();
+
+  {
+    InlineDynamicArray<LifetimeTracker, 4> a;
+    a.emplaceBack(1, 2);
+    a.emplaceBack(3, 4);
+    a.emplaceBack(5, 6);
+
+    a.remove(a.begin());
+    REQUIRE(a.size() == 2);
+    CHECK(a[0].a() == 3);
+
+    a.remove(LifetimeTracker{5, 6});
+    REQUIRE(a.size() == 1);
+
+    a.resize(3);
+    CHECK(a[2].a() == 0);
+
+    a.removeAll();
+    CHECK(a.empty());
+  }
+
+  // Removing shifts elements down with move assignment, which does not create new objects.
+  CHECK(LifetimeTracker::creates == LifetimeTracker::destroys);
+}
+
+TEST_CASE("InlineDynamicArray compaction") {
+  {
+    InlineDynamicArray<LifetimeTracker, 4> a;
+    for (I32 i = 0; i < 10; ++i) {
+      a.emplaceBack(i, i);
+    }
+
+    CHECK(a.removeIf([](const LifetimeTracker& tracker) { return tracker.a() < 3; }) == 3);
+    REQUIRE(a.size() == 7);
+    CHECK(a[0].a() == 3);
+
+    CHECK(a.removeAll(LifetimeTracker{5, 5}) == 1);
+    CHECK(a.retain([](const LifetimeTracker& tracker) { return tracker.a() % 2 == 0; }) == 3);
+    REQUIRE(a.size() == 3);
+    CHECK(a[0].a() == 4);
+    CHECK(a[1].a() == 6);
+    CHECK(a[2].a() == 8);
+
+    LifetimeTracker::reset();
+    a.swapRemove(a.begin());
+    REQUIRE(a.size() == 2);
+    CHECK(a[0].a() == 8);
+    CHECK(a[1].a() == 6);
+    CHECK(LifetimeTracker::destroys == 1);
+  }
+
+  CHECK(LifetimeTracker::copies == 0);
+}
+
+TEST_CASE("InlineDynamicArray only allocates what does not fit inline") {
+  AllocationCounts counts;
+
+  {
+    InlineDynamicArray<I32, 4, CountingAllocator> a{CountingAllocator{&counts}};
+    for (I32 i = 0; i < 4; ++i) {
+      a.pushBack(i);
+    }
+    CHECK(counts.allocations == 0);
+
+    a.pushBack(4);
+    CHECK(counts.allocations == 1);
+    CHECK(counts.bytesInUse == a.capacity() * sizeof(I32));
+  }
+
+  CHECK(counts.bytesInUse == 0);
+}
+
+}  // namespace nu
@@ -0,0 +1,101 @@
+#include <catch2/catch.hpp>
+
+#include <atomic>
+
+#include "nucleus/containers/read_mostly_hash_map.h"
+#include "nucleus/threading/thread.h"
+
+namespace nu {
+
+TEST_CASE("ReadMostlyHashMap") {
+  EpochDomain domain;
+
+  SECTION("basic") {
+    ReadMostlyHashMap<I32, I32> map{&domain};
+
+    CHECK(map.size() == 0);
+    CHECK(map.insert(1, 10));
+    CHECK(!map.insert(1, 11));
+    CHECK(map.insert(2, 20));
+    CHECK(map.size() == 2);
+
+    I32 value = 0;
+    CHECK(map.find(1, &value));
+    CHECK(value == 11);
+    CHECK(!map.find(3, &value));
+
+    CHECK(map.remove(2));
+    CHECK(!map.remove(2));
+    CHECK(!map.contains_key(2));
+
+    // Nobody is reading, so old versions are deleted right away.
+    CHECK(domain.pending() == 0);
+  }
+
+  SECTION("snapshots stay valid until a quiescent point") {
+    ReadMostlyHashMap<I32, I32> map{&domain};
+    map.insert(1, 10);
+
+    EpochDomain::Participant reader{&domain};
+    const auto& before = map.snapshot();
+
+    map.update([](ReadMostlyHashMap<I32, I32>::MapType& m) {
+      m.insert(2, 20);
+      m.insert(3, 30);
+    });
+    CHECK(domain.pending() == 1);
+
+    CHECK(before.size() == 1);
+    CHECK(before.find(1).value() == 10);
+    CHECK(map.size() == 3);
+
+    reader.quiescent();
+    domain.collect();
+    CHECK(domain.pending() == 0);
+  }
+}
+
+TEST_CASE("ReadMostlyHashMap with concurrent readers") {
+  EpochDomain domain;
+  ReadMostlyHashMap<I32, I32> map{&domain};
+  map.insert(0, 0);
+
+  std::atomic<bool> done{false};
+  std::atomic<I32> failures{0};
+
+  auto reader = [&]() {
+    EpochDomain::Participant participant{&domain};
+
+    while (!done.load()) {
+      // Every version of the map has all the keys up to its largest value.
+      I32 largest = 0;
+      map.find(0, &largest);
+      for (I32 i = 0; i <= largest; ++i) {
+        if (!map.snapshot().contains_key(i)) {
+          ++failures;
+        }
+      }
+      participant.quiescent();
+    }
+  };
+
+  {
+    auto t1 = spawn_thread(reader);
+    auto t2 = spawn_thread(reader);
+
+    for (I32 i = 1; i <= 200; ++i) {
+      map.update([i](ReadMostlyHashMap<I32, I32>::MapType& m) {
+        m.insert(i, i);
+        m.insert(0, i);
+      });
+    }
+
+    done.store(true);
+  }
+
+  CHECK(failures.load() == 0);
+  domain.collect();
+  CHECK(domain.pending() == 0);
+}
+
+}  // namespace nu
@@ -0,0 +1,156 @@
+#include <catch2/catch.hpp>
+
+#include "nucleus/containers/segmented_array.h"
+#include "nucleus/testing/counting_allocator.h"
+#include "nucleus/testing/lifetime_tracker.h"
+#include "nucleus/threading/thread.h"
+
+namespace nu {
+
+using testing::AllocationCounts;
+using testing::CountingAllocator;
+using testing::LifetimeTracker;
+
+TEST_CASE("SegmentedArray construct") {
+  SegmentedArray<I32> a;
+
+  CHECK(a.size() == 0);
+  CHECK(a.empty());
+  CHECK(a.capacity() == 0);
+  CHECK(a.segmentCount() == 0);
+}
+
+TEST_CASE("SegmentedArray indexing") {
+  SegmentedArray<U64, 4> a;
+  for (U64 i = 0; i < 1000; ++i) {
+    CHECK(a.pushBack(i * 3) == i * 3);
+  }
+
+  REQUIRE(a.size() == 1000);
+  for (MemSize i = 0; i < a.size(); ++i) {
+    REQUIRE(a[i] == i * 3);
+  }
+  CHECK(a.last() == 999 * 3);
+
+  // Segments of 4, 8, 16, ... elements.
+  CHECK(a.capacity() == 4 + 8 + 16 + 32 + 64 + 128 + 256 + 512);
+  CHECK(a.segmentCount() == 8);
+}
+
+TEST_CASE("SegmentedArray never moves elements") {
+  SegmentedArray<I32, 2> a;
+  I32* first = &a.pushBack(1);
+  I32* second = &a.pushBack(2);
+
+  for (I32 i = 0; i < 10000; ++i) {
+    a.pushBack(i);
+  }
+
+  CHECK(&a[0] == first);
+  CHECK(&a[1] == second);
+  CHECK(*first == 1);
+  CHECK(*second == 2);
+}
+
+TEST_CASE("SegmentedArray segments cover all the elements") {
+  SegmentedArray<I32, 8> a;
+  for (I32 i = 0; i < 100; ++i) {
+    a.pushBack(i);
+  }
+
+  REQUIRE(a.segmentCount() == 4);
+  CHECK(a.segment(0).size() == 8);
+  CHECK(a.segment(1).size() == 16);
+  CHECK(a.segment(2).size() == 32);
+  // Only the published part of the last segment.
+  CHECK(a.segment(3).size() == 100 - 56);
+
+  I32 expected = 0;
+  for (MemSize i = 0; i < a.segmentCount(); ++i) {
+    for (I32 value : a.segment(i)) {
+      REQUIRE(value == expected);
+      ++expected;
+    }
+  }
+  CHECK(expected == 100);
+}
+
+TEST_CASE("SegmentedArray grows without copying") {
+  AllocationCounts counts;
+
+  {
+    SegmentedArray<I32, 16, CountingAllocator> a{CountingAllocator{&counts}};
+    for (I32 i = 0; i < 16 * 15; ++i) {
+      a.pushBack(i);
+    }
+
+    // One allocation per segment, and nothing given back until the array goes away.
+    CHECK(counts.allocations == 4);
+    CHECK(counts.deallocations == 0);
+    CHECK(counts.bytesInUse == a.capacity() * sizeof(I32));
+
+    a.reserve(16 * 31);
+    CHECK(counts.allocations == 5);
+    CHECK(a.size() == 16 * 15);
+  }
+
+  CHECK(counts.deallocations == 5);
+  CHECK(counts.bytesInUse == 0);
+}
+
+TEST_CASE("SegmentedArray destroys its elements") {
+  LifetimeTracker::reset();
+
+  {
+    SegmentedArray<LifetimeTracker, 4> a;
+    for (I32 i = 0; i < 50; ++i) {
+      a.emplaceBack(i, i);
+    }
+    CHECK(a[49].a() == 49);
+
+    // Growing never moves or copies.
+    CHECK(LifetimeTracker::moves == 0);
+    CHECK(LifetimeTracker::copies == 0);
+
+    a.clear();
+    CHECK(a.empty());
+    CHECK(LifetimeTracker::destroys == 50);
+
+    a.emplaceBack(1, 2);
+  }
+
+  CHECK(LifetimeTracker::creates == LifetimeTracker::destroys);
+}
+
+TEST_CASE("SegmentedArray can be read while elements are added") {
+  constexpr U64 COUNT = 200000;
+
+  SegmentedArray<U64, 16> a;
+  bool wrong = false;
+  U64 reads = 0;
+
+  {
+    auto writer = spawn_thread([&a]() {
+      for (U64 i = 0; i < COUNT; ++i) {
+        a.pushBack(i * 7);
+      }
+    });
+
+    MemSize size = 0;
+    while (size < COUNT) {
+      size = a.size();
+      if (size > 0 && a[size - 1] != (size - 1) * 7) {
+        wrong = true;
+      }
+      ++reads;
+    }
+  }
+
+  CHECK_FALSE(wrong);
+  CHECK(reads > 0);
+  for (MemSize i = 0; i < COUNT; ++i) {
+    REQUIRE(a[i] == i * 7);
+  }
+}
+
+}  // namespace nu
@@ -0,0 +1,177 @@
+#include <catch2/catch.hpp>
+
+#include "nucleus/containers/soa_array.h"
+#include "nucleus/testing/counting_allocator.h"
+#include "nucleus/testing/lifetime_tracker.h"
+#include "nucleus/text/dynamic_string.h"
+
+namespace nu {
+
+using testing::AllocationCounts;
+using testing::CountingAllocator;
+using testing::LifetimeTracker;
+
+TEST_CASE("SoAArray construct") {
+  SoAArray<I32, F32> a;
+
+  CHECK(a.size() == 0);
+  CHECK(a.empty());
+  CHECK(a.capacity() == 0);
+  CHECK(a.column<0>().empty());
+}
+
+TEST_CASE("SoAArray pushBack stores every field in its own column") {
+  SoAArray<I32, F64, U8> a;
+  for (I32 i = 0; i < 100; ++i) {
+    auto row = a.pushBack(i, i * 0.5, static_cast<U8>(i * 2));
+    CHECK(row.index() == static_cast<MemSize>(i));
+  }
+
+  REQUIRE(a.size() == 100);
+  CHECK(a.capacity() >= 100);
+
+  auto ids = a.column<0>();
+  auto weights = a.column<1>();
+  auto flags = a.column<2>();
+  REQUIRE(ids.size() == 100);
+  for (MemSize i = 0; i < a.size(); ++i) {
+    CHECK(ids[i] == static_cast<I32>(i));
+    CHECK(weights[i] == static_cast<F64>(i) * 0.5);
+    CHECK(flags[i] == static_cast<U8>(i * 2));
+  }
+
+  // Every column starts on its own aligned boundary.
+  constexpr auto ALIGNMENT = SoAArray<I32, F64, U8>::COLUMN_ALIGNMENT;
+  CHECK(reinterpret_cast<MemSize>(ids.data()) % ALIGNMENT == 0);
+  CHECK(reinterpret_cast<MemSize>(weights.data()) % ALIGNMENT == 0);
+  CHECK(reinterpret_cast<MemSize>(flags.data()) % ALIGNMENT == 0);
+}
+
+TEST_CASE("SoAArray rows") {
+  SoAArray<I32, F32> a;
+  a.pushBack(1, 1.0f);
+  a.pushBack(2, 2.0f);
+
+  SECTION("get fields") {
+    CHECK(a[0].get<0>() == 1);
+    CHECK(a[1].get<1>() == 2.0f);
+    CHECK(a.last().get<0>() == 2);
+  }
+
+  SECTION("structured bindings change the array") {
+    auto [id, value] = a[1];
+    id = 20;
+    value += 0.5f;
+
+    CHECK(a[1].get<0>() == 20);
+    CHECK(a[1].get<1>() == 2.5f);
+  }
+
+  SECTION("const rows") {
+    const auto& c = a;
+    auto [id, value] = c[0];
+    static_assert(std::is_same_v<decltype(id), const I32>);
+    CHECK(id == 1);
+    CHECK(value == 1.0f);
+  }
+}
+
+TEST_CASE("SoAArray column iteration") {
+  SoAArray<I32, I32> a;
+  for (I32 i = 0; i < 10; ++i) {
+    a.pushBack(i, 0);
+  }
+
+  for (auto& value : a.column<1>()) {
+    value = 3;
+  }
+
+  I32 sum = 0;
+  for (I32 value : static_cast<const SoAArray<I32, I32>&>(a).column<0>()) {
+    sum += value;
+  }
+  CHECK(sum == 45);
+
+  ArrayView<I32> second = a.column<1>();
+  for (MemSize i = 0; i < second.size(); ++i) {
+    CHECK(second[i] == 3);
+  }
+}
+
+TEST_CASE("SoAArray removing rows") {
+  SoAArray<I32, DynamicString> a;
+  a.pushBack(1, DynamicString{"one"});
+  a.pushBack(2, DynamicString{"two"});
+  a.pushBack(3, DynamicString{"three"});
+  a.pushBack(4, DynamicString{"four"});
+
+  a.swapRemove(1);
+  REQUIRE(a.size() == 3);
+  CHECK(a[1].get<0>() == 4);
+  CHECK(a[1].get<1>() == "four");
+
+  a.popBack();
+  REQUIRE(a.size() == 2);
+  CHECK(a.last().get<1>() == "four");
+
+  a.resize(4);
+  REQUIRE(a.size() == 4);
+  CHECK(a[3].get<0>() == 0);
+  CHECK(a[3].get<1>().empty());
+
+  auto capacity = a.capacity();
+  a.removeAll();
+  CHECK(a.empty());
+  CHECK(a.capacity() == capacity);
+
+  a.clear();
+  CHECK(a.capacity() == 0);
+}
+
+TEST_CASE("SoAArray keeps objects alive across growth") {
+  LifetimeTracker::reset();
+
+  {
+    SoAArray<LifetimeTracker, I32> a;
+    for (I32 i = 0; i < 100; ++i) {
+      a.pushBack(LifetimeTracker{i, i}, i);
+    }
+
+    for (MemSize i = 0; i < a.size(); ++i) {
+      REQUIRE(a[i].get<0>().a() == static_cast<I32>(i));
+    }
+
+    SoAArray<LifetimeTracker, I32> copy = a;
+    CHECK(copy.size() == 100);
+    CHECK(copy[99].get<0>().a() == 99);
+
+    SoAArray<LifetimeTracker, I32> moved = std::move(a);
+    CHECK(a.empty());
+    CHECK(moved.size() == 100);
+    CHECK(moved[50].get<1>() == 50);
+  }
+
+  // Every object that was constructed in any way was also destroyed.
+  CHECK(LifetimeTracker::creates + LifetimeTracker::copies + LifetimeTracker::moves ==
+        LifetimeTracker::destroys);
+}
+
+TEST_CASE("SoAArray allocates all the columns at once") {
+  AllocationCounts counts;
+
+  {
+    BasicSoAArray<CountingAllocator, I32, F64> a{CountingAllocator{&counts}};
+    a.reserve(10);
+    CHECK(counts.allocations == 1);
+
+    for (I32 i = 0; i < 100; ++i) {
+      a.pushBack(i, 0.0);
+    }
+    CHECK(counts.bytesInUse > 100 * (sizeof(I32) + sizeof(F64)));
+  }
+
+  CHECK(counts.allocations == counts.deallocations);
+  CHECK(counts.bytesInUse == 0);
+}
+
+}  // namespace nu
@@ -0,0 +1,109 @@
+#include <catch2/catch.hpp>
+
+#include "nucleus/containers/stable_hash_map.h"
+#include "nucleus/text/dynamic_string.h"
+
+namespace nu {
+
+TEST_CASE("StableHashMap") {
+  StableHashMap<I32, I32> map;
+
+  SECTION("basic") {
+    CHECK(map.empty());
+    CHECK(!map.contains_key(1));
+
+    auto result = map.insert(1, 10);
+    CHECK(result.is_new());
+    CHECK(result.key() == 1);
+    CHECK(result.value() == 10);
+
+    CHECK(!map.insert(1, 11).is_new());
+    CHECK(map.size() == 1);
+    CHECK(map.find(1).value() == 11);
+
+    CHECK(map.remove(1));
+    CHECK(!map.remove(1));
+    CHECK(map.empty());
+  }
+
+  SECTION("pointers survive growth") {
+    auto* value = &map.insert(0, 0).value();
+    auto capacity = map.capacity();
+
+    for (I32 i = 1; i < 1000; ++i) {
+      map.insert(i, i * 10);
+    }
+    CHECK(map.capacity() > capacity);
+
+    // Replacing the value keeps the item where it is.
+    map.insert(0, 5);
+    CHECK(&map.find(0).value() == value);
+    CHECK(*value == 5);
+
+    for (I32 i = 1; i < 1000; ++i) {
+      REQUIRE(map.find(i).value() == i * 10);
+    }
+  }
+
+  SECTION("iterate") {
+    for (I32 i = 0; i < 100; ++i) {
+      map.insert(i, i);
+    }
+    for (I32 i = 0; i < 100; i += 2) {
+      map.remove(i);
+    }
+
+    I32 count = 0;
+    for (auto& item : map) {
+      CHECK(item.key % 2 == 1);
+      CHECK(item.value == item.key);
+      ++count;
+    }
+    CHECK(count == 50);
+  }
+
+  SECTION("erase while iterating") {
+    for (I32 i = 0; i < 100; ++i) {
+      map.insert(i, i);
+    }
+
+    for (auto it = map.begin(); it != map.end();) {
+      if (it->key < 50) {
+        it = map.erase(it);
+      } else {
+        ++it;
+      }
+    }
+
+    CHECK(map.size() == 50);
+    CHECK(!map.contains_key(10));
+    CHECK(map.find(60).value() == 60);
+  }
+
+  SECTION("clear") {
+    for (I32 i = 0; i < 100; ++i) {
+      map.insert(i, i);
+    }
+    map.clear();
+    CHECK(map.empty());
+    CHECK(!map.contains_key(1));
+
+    map.insert(1, 1);
+    CHECK(map.find(1).value() == 1);
+  }
+}
+
+TEST_CASE("StableHashMap lookups by hash compatible type") {
+  StableHashMap<DynamicString, I32> map;
+  map.insert(DynamicString{"one"}, 1);
+  map.insert(DynamicString{"two"}, 2);
+
+  CHECK(map.contains_key(StringView{"one"}));
+  CHECK(map.find(StringView{"two"}).value() == 2);
+  CHECK(!map.contains_key(StringView{"three"}));
+
+  CHECK(map.remove(StringView{"one"}));
+  CHECK(map.size() == 1);
+}
+
+}  // namespace nu
@@ -1,3 +1,4 @@
+#include <nucleus/testing/counting_allocator.h>
 #include <nucleus/testing/lifetime_tracker.h>
 
 #include <catch2/catch.hpp>
@@ -27,7 +28,90 @@ TEST_CASE("StablePool") {
     CHECK(b->b() == 21);
 
     CHECK(sp.remove(b));
+    CHECK(sp.size() == 1);
+
+    LifetimeTracker outside;
+    CHECK(!sp.remove(&outside));
+  }
+
+  SECTION("pointers are stable while growing") {
+    StablePool<LifetimeTracker, 8> sp;
+
+    auto* first = sp.construct(1, 2);
+    for (I32 i = 0; i < 100; ++i) {
+      sp.construct(i, i);
+    }
+
+    CHECK(sp.size() == 101);
+    CHECK(sp.capacity() >= 101);
+    CHECK(first->a() == 1);
+    CHECK(first->b() == 2);
+  }
+
+  SECTION("removed slots are reused") {
+    StablePool<LifetimeTracker, 8> sp;
+
+    StablePool<LifetimeTracker, 8>::Index indices[20];
+    for (I32 i = 0; i < 20; ++i) {
+      indices[i] = sp.construct_indexed(i, i);
+    }
+    auto capacity = sp.capacity();
+
+    sp.remove_at(indices[3]);
+    sp.remove_at(indices[17]);
+    CHECK(sp.size() == 18);
+
+    auto reused = sp.insert_indexed({100, 100});
+    CHECK((reused == indices[3] || reused == indices[17]));
+    CHECK(sp.at(reused).a() == 100);
+    CHECK(sp.at(indices[4]).a() == 4);
+    CHECK(sp.capacity() == capacity);
   }
+
+  SECTION("full pools of 64") {
+    StablePool<I32, 64> sp;
+
+    for (I32 i = 0; i < 200; ++i) {
+      auto index = sp.construct_indexed(i);
+      CHECK(sp.at(index) == i);
+    }
+    CHECK(sp.size() == 200);
+    CHECK(sp.capacity() == 256);
+  }
+
+  SECTION("destroys objects") {
+    LifetimeTracker::reset();
+    {
+      StablePool<LifetimeTracker, 8> sp;
+      for (I32 i = 0; i < 10; ++i) {
+        sp.construct(i, i);
+      }
+      sp.remove_at(0);
+      CHECK(LifetimeTracker::destroys == 1);
+    }
+    CHECK(LifetimeTracker::destroys == 10);
+  }
+}
+
+TEST_CASE("StablePool gets its memory from the allocator") {
+  AllocationCounts counts;
+
+  {
+    StablePool<I32, 8, CountingAllocator> sp{CountingAllocator{&counts}};
+    for (I32 i = 0; i < 20; ++i) {
+      sp.construct(i);
+    }
+    CHECK(counts.bytesInUse >= sp.capacity() * sizeof(I32));
+
+    sp.clear();
+    CHECK(counts.bytesInUse == 0);
+
+    sp.construct(1);
+    CHECK(counts.bytesInUse > 0);
+  }
+
+  CHECK(counts.allocations == counts.deallocations);
+  CHECK(counts.bytesInUse == 0);
 }
 
 }  // namespace nu
@@ -1,6 +1,11 @@
 #include <catch2/catch.hpp>
 
+#include <bit>
+#include <cstring>
+
 #include "nucleus/hash.h"
+#include "nucleus/text/dynamic_string.h"
+#include "nucleus/text/string_view.h"
 
 namespace nu {
 
@@ -9,4 +14,114 @@ TEST_CASE("hash basic") {
   CHECK(hash != 10);
 }
 
+namespace {
+
+constexpr char TEXT[] =
+    "The quick brown fox jumps over the lazy dog, then it jumps back over the lazy dog again and "
+    "again until the dog is no longer lazy and starts chasing the fox all over the place.";
+constexpr MemSize TEXT_LENGTH = sizeof(TEXT) - 1;
+
+// Hashes of every prefix of `TEXT`, calculated at compile time.
+constexpr auto hash_prefixes() {
+  struct {
+    U64 values[TEXT_LENGTH + 1];
+  } result{};
+
+  for (MemSize length = 0; length <= TEXT_LENGTH; ++length) {
+    result.values[length] = hash_bytes(TEXT, length);
+  }
+
+  return result;
+}
+
+}  // namespace
+
+TEST_CASE("hash_bytes") {
+  SECTION("is the same at compile time and at run time") {
+    constexpr auto expected = hash_prefixes();
+
+    // Loads at every alignment.
+    char buffer[TEXT_LENGTH + 8];
+    for (MemSize offset = 0; offset < 8; ++offset) {
+      std::memcpy(buffer + offset, TEXT, TEXT_LENGTH);
+      for (MemSize length = 0; length <= TEXT_LENGTH; ++length) {
+        CHECK(hash_bytes(buffer + offset, length) == expected.values[length]);
+      }
+    }
+  }
+
+  SECTION("every prefix has a different hash") {
+    constexpr auto hashes = hash_prefixes();
+    for (MemSize i = 0; i <= TEXT_LENGTH; ++i) {
+      for (MemSize j = i + 1; j <= TEXT_LENGTH; ++j) {
+        CHECK(hashes.values[i] != hashes.values[j]);
+      }
+    }
+  }
+
+  SECTION("seed") {
+    CHECK(hash_bytes(TEXT, TEXT_LENGTH, 1) != hash_bytes(TEXT, TEXT_LENGTH, 2));
+    CHECK(hash_bytes(TEXT, 0, 1) != hash_bytes(TEXT, 0, 2));
+  }
+
+  SECTION("a single flipped bit changes about half of the hash") {
+    char buffer[TEXT_LENGTH];
+    std::memcpy(buffer, TEXT, TEXT_LENGTH);
+
+    for (MemSize length : {1, 3, 8, 16, 17, 48, 49, 100}) {
+      U64 original = hash_bytes(buffer, length);
+
+      MemSize total_changed = 0;
+      for (MemSize bit = 0; bit < length * 8; ++bit) {
+        buffer[bit / 8] ^= static_cast<char>(1 << (bit % 8));
+        total_changed += std::popcount(original ^ hash_bytes(buffer, length));
+        buffer[bit / 8] ^= static_cast<char>(1 << (bit % 8));
+      }
+
+      F64 average = static_cast<F64>(total_changed) / static_cast<F64>(length * 8);
+      CHECK(average > 24.0);
+      CHECK(average < 40.0);
+    }
+  }
+}
+
+TEST_CASE("hash StringView") {
+  constexpr HashedValue hash = Hash<StringView>::hashed(StringView{"compile time"});
+  static_assert(hash == Hash<StringView>::hashed(StringView{"compile time"}));
+
+  char buffer[] = "compile time";
+  CHECK(Hash<StringView>::hashed(StringView{buffer}) == hash);
+  CHECK(Hash<StringView>::hashed(StringView{"compile"}) != hash);
+}
+
+TEST_CASE("keyed_hash_bytes") {
+  SECTION("SipHash-2-4 reference vector") {
+    // From the SipHash paper: key 00..0f and the 15 byte message 00..0e.
+    HashKey key{0x0706050403020100ull, 0x0f0e0d0c0b0a0908ull};
+    char message[15];
+    for (I32 i = 0; i < 15; ++i) {
+      message[i] = static_cast<char>(i);
+    }
+
+    CHECK(detail::sip_hash<2, 4>(message, sizeof(message), key) == 0xa129ca6149be45e5ull);
+  }
+
+  SECTION("depends on the key") {
+    HashKey first{1, 2};
+    HashKey second{1, 3};
+
+    for (MemSize length = 0; length <= TEXT_LENGTH; ++length) {
+      CHECK(keyed_hash_bytes(TEXT, length, first) != keyed_hash_bytes(TEXT, length, second));
+    }
+  }
+
+  SECTION("seeded hashes are stable within the process") {
+    CHECK(SeededHash<StringView>::hashed("text") == SeededHash<StringView>::hashed("text"));
+    CHECK(SeededHash<DynamicString>::hashed(DynamicString{"text"}) ==
+          SeededHash<StringView>::hashed("text"));
+    CHECK(SeededHash<I32>::hashed(10) == SeededHash<I32>::hashed(10));
+    CHECK(SeededHash<I32>::hashed(10) != SeededHash<I32>::hashed(11));
+  }
+}
+
 }  // namespace nu
@@ -0,0 +1,102 @@
+#include <catch2/catch.hpp>
+
+#include <cstring>
+
+#include "nucleus/hasher.h"
+
+namespace nu {
+
+namespace {
+
+U64 hash_all(Hasher::Algorithm algorithm, const void* data, MemSize size, U64 seed = 0) {
+  Hasher hasher{algorithm, seed};
+  hasher.update(data, size);
+  return hasher.finish();
+}
+
+U64 hash_string(Hasher::Algorithm algorithm, const char* text) {
+  return hash_all(algorithm, text, std::strlen(text));
+}
+
+}  // namespace
+
+TEST_CASE("Hasher XXH64") {
+  using Algorithm = Hasher::Algorithm;
+
+  SECTION("reference values") {
+    CHECK(hash_string(Algorithm::XXH64, "") == 0xEF46DB3751D8E999ull);
+    CHECK(hash_string(Algorithm::XXH64, "a") == 0xD24EC4F1A98C6E5Bull);
+    CHECK(hash_string(Algorithm::XXH64, "abc") == 0x44BC2CF5AD770999ull);
+  }
+
+  SECTION("seed") {
+    CHECK(hash_all(Algorithm::XXH64, "abc", 3, 1) != hash_all(Algorithm::XXH64, "abc", 3, 2));
+  }
+}
+
+TEST_CASE("Hasher CRC32C") {
+  using Algorithm = Hasher::Algorithm;
+
+  SECTION("reference values") {
+    CHECK(hash_string(Algorithm::CRC32C, "") == 0);
+    CHECK(hash_string(Algorithm::CRC32C, "123456789") == 0xE3069283);
+
+    // From RFC 3720, appendix B.4.
+    U8 data[32];
+    std::memset(data, 0, sizeof(data));
+    CHECK(hash_all(Algorithm::CRC32C, data, sizeof(data)) == 0x8A9136AA);
+    std::memset(data, 0xFF, sizeof(data));
+    CHECK(hash_all(Algorithm::CRC32C, data, sizeof(data)) == 0x62A8AB43);
+    for (U8 i = 0; i < 32; ++i) {
+      data[i] = i;
+    }
+    CHECK(hash_all(Algorithm::CRC32C, data, sizeof(data)) == 0x46DD794E);
+  }
+
+  SECTION("software and hardware agree") {
+    U8 data[300];
+    for (MemSize i = 0; i < sizeof(data); ++i) {
+      data[i] = static_cast<U8>(i * 7 + 3);
+    }
+
+    for (MemSize size = 0; size <= sizeof(data); ++size) {
+      U32 software = ~detail::crc32c_software(~0u, data, size);
+      CHECK(hash_all(Algorithm::CRC32C, data, size) == software);
+    }
+  }
+
+  SECTION("continue from a seed") {
+    const char* text = "123456789";
+    U64 first = hash_all(Algorithm::CRC32C, text, 4);
+    CHECK(hash_all(Algorithm::CRC32C, text + 4, 5, first) == 0xE3069283);
+  }
+}
+
+TEMPLATE_TEST_CASE_SIG("Hasher incremental updates", "", ((Hasher::Algorithm A), A),
+                       Hasher::Algorithm::XXH64, Hasher::Algorithm::CRC32C) {
+  U8 data[1000];
+  for (MemSize i = 0; i < sizeof(data); ++i) {
+    data[i] = static_cast<U8>(i * 31 + 17);
+  }
+
+  U64 expected = hash_all(A, data, sizeof(data));
+
+  // Every split into chunks of the same size, including sizes that do not line up with stripes.
+  for (MemSize chunk = 1; chunk <= 70; ++chunk) {
+    Hasher hasher{A};
+    for (MemSize offset = 0; offset < sizeof(data); offset += chunk) {
+      hasher.update(ArrayView<U8>{data + offset, std::min(chunk, sizeof(data) - offset)});
+    }
+    CHECK(hasher.finish() == expected);
+  }
+
+  SECTION("reset") {
+    Hasher hasher{A};
+    hasher.update(data, 10);
+    hasher.reset();
+    hasher.update(data, sizeof(data));
+    CHECK(hasher.finish() == expected);
+  }
+}
+
+}  // namespace nu
@@ -0,0 +1,124 @@
+#include <catch2/catch.hpp>
+
+#include "nucleus/containers/dynamic_array.h"
+#include "nucleus/containers/hash_map.h"
+#include "nucleus/containers/stable_pool.h"
+#include "nucleus/memory/allocation_accounting.h"
+#include "nucleus/memory/arena.h"
+#include "nucleus/text/dynamic_string.h"
+#include "nucleus/text/string_pool.h"
+#include "nucleus/threading/thread.h"
+
+namespace nu {
+
+namespace {
+
+// Counts allocations from a clean slate for as long as it lives.
+class ScopedAccounting {
+public:
+  ScopedAccounting() {
+    reset_allocation_accounting();
+    enable_allocation_accounting();
+  }
+
+  ~ScopedAccounting() {
+    enable_allocation_accounting(false);
+    reset_allocation_accounting();
+  }
+};
+
+}  // namespace
+
+TEST_CASE("Allocation accounting counts live and peak bytes") {
+  ScopedAccounting accounting;
+
+  {
+    DynamicArray<I32> numbers;
+    for (I32 i = 0; i < 100; ++i) {
+      numbers.pushBack(i);
+    }
+
+    auto snapshot = take_allocation_snapshot();
+    auto& stats = snapshot[AllocationTag::DynamicArray];
+    CHECK(stats.live_bytes == static_cast<I64>(numbers.capacity() * sizeof(I32)));
+    CHECK(stats.peak_bytes >= stats.live_bytes);
+    CHECK(stats.allocations > 0);
+  }
+
+  auto snapshot = take_allocation_snapshot();
+  auto& stats = snapshot[AllocationTag::DynamicArray];
+  CHECK(stats.live_bytes == 0);
+  CHECK(stats.peak_bytes >= static_cast<I64>(128 * sizeof(I32)));
+  CHECK(stats.allocations == stats.deallocations);
+}
+
+TEST_CASE("Allocation accounting tags each kind of container") {
+  ScopedAccounting accounting;
+
+  HashMap<I32, I32> map;
+  map.insert(1, 2);
+
+  DynamicString str{"a string that needs memory"};
+
+  StablePool<I32> pool;
+  pool.construct(1);
+
+  StringPool<> strings;
+  strings.store("pooled");
+
+  Arena arena;
+  arena.allocate(16);
+
+  auto snapshot = take_allocation_snapshot();
+  CHECK(snapshot[AllocationTag::HashTable].live_bytes > 0);
+  CHECK(snapshot[AllocationTag::DynamicString].live_bytes == static_cast<I64>(str.capacity()));
+  CHECK(snapshot[AllocationTag::StablePool].live_bytes > 0);
+  CHECK(snapshot[AllocationTag::StringPool].live_bytes > 0);
+  CHECK(snapshot[AllocationTag::Arena].live_bytes >= static_cast<I64>(Arena::DEFAULT_BLOCK_SIZE));
+}
+
+TEST_CASE("Allocation accounting with user tags") {
+  constexpr auto NETWORK_TAG = user_allocation_tag<0>();
+  set_allocation_tag_name(NETWORK_TAG, "network");
+  CHECK(allocation_tag_name(NETWORK_TAG) == "network");
+  CHECK(allocation_tag_name(AllocationTag::HashTable) == "hash_table");
+
+  ScopedAccounting accounting;
+
+  DynamicArray<U8, MallocAllocator<NETWORK_TAG>> buffer;
+  buffer.resize(1000);
+
+  auto snapshot = take_allocation_snapshot();
+  CHECK(snapshot[NETWORK_TAG].live_bytes == static_cast<I64>(buffer.capacity()));
+  CHECK(snapshot[AllocationTag::DynamicArray].live_bytes == 0);
+}
+
+TEST_CASE("Allocation accounting adds up all threads") {
+  ScopedAccounting accounting;
+
+  auto* shared = new DynamicArray<U64>;
+
+  {
+    auto handle = spawn_thread([shared]() {
+      // Enough bytes for the thread to report them to the totals more than once.
+      for (I32 i = 0; i < 100; ++i) {
+        auto temp = DynamicArray<U64>::withInitialCapacity(1024);
+      }
+      shared->resize(1000);
+    });
+  }
+
+  auto snapshot = take_allocation_snapshot();
+  auto& stats = snapshot[AllocationTag::DynamicArray];
+  CHECK(stats.allocations >= 101);
+  CHECK(stats.deallocations == stats.allocations - 1);
+  CHECK(stats.live_bytes == static_cast<I64>(shared->capacity() * sizeof(U64)));
+  CHECK(stats.peak_bytes >= stats.live_bytes);
+
+  // Memory allocated on one thread and freed on another still balances out.
+  delete shared;
+  snapshot = take_allocation_snapshot();
+  CHECK(snapshot[AllocationTag::DynamicArray].live_bytes == 0);
+}
+
+}  // namespace nu
@@ -0,0 +1,119 @@
+#include <catch2/catch.hpp>
+
+#include "nucleus/memory/arena.h"
+
+namespace nu {
+
+TEST_CASE("Arena allocates aligned memory") {
+  Arena arena{64};
+
+  auto* a = static_cast<U8*>(arena.allocate(1, 1));
+  auto* b = arena.allocate(8, 8);
+  auto* c = arena.allocate(32, 32);
+
+  CHECK(reinterpret_cast<MemSize>(b) % 8 == 0);
+  CHECK(reinterpret_cast<MemSize>(c) % 32 == 0);
+  CHECK(static_cast<U8*>(b) > a);
+
+  auto* value = arena.construct<U64>(10u);
+  CHECK(*value == 10);
+}
+
+TEST_CASE("Arena grows in blocks twice the size of the one before") {
+  Arena arena{64};
+
+  arena.allocate(48);
+  CHECK(arena.bytes_reserved() == 64);
+
+  arena.allocate(48);
+  CHECK(arena.bytes_reserved() == 64 + 128);
+
+  // Allocations larger than the next block get a block of their own that is large enough.
+  arena.allocate(1000);
+  CHECK(arena.bytes_reserved() == 64 + 128 + 1024);
+}
+
+TEST_CASE("Arena reset keeps the blocks") {
+  Arena arena{64};
+
+  void* first = arena.allocate(16);
+  for (I32 i = 0; i < 100; ++i) {
+    arena.allocate(16);
+  }
+  auto reserved = arena.bytes_reserved();
+  CHECK(arena.bytes_used() >= 101 * 16);
+
+  arena.reset();
+  CHECK(arena.bytes_used() == 0);
+  CHECK(arena.allocate(16) == first);
+
+  for (I32 i = 0; i < 100; ++i) {
+    arena.allocate(16);
+  }
+  CHECK(arena.bytes_reserved() == reserved);
+}
+
+TEST_CASE("Arena scope gives back its allocations") {
+  Arena arena{64};
+
+  arena.allocate(16);
+  auto used = arena.bytes_used();
+
+  void* inside;
+  {
+    Arena::Scope scope{&arena};
+    inside = arena.allocate(16);
+    for (I32 i = 0; i < 20; ++i) {
+      arena.allocate(16);
+    }
+    CHECK(arena.bytes_used() > used);
+  }
+
+  CHECK(arena.bytes_used() == used);
+  CHECK(arena.allocate(16) == inside);
+}
+
+TEST_CASE("Arena reallocates the last allocation in place") {
+  Arena arena{256};
+
+  auto* a = static_cast<U8*>(arena.allocate(16));
+  a[0] = 42;
+  CHECK(arena.reallocate(a, 16, 64, alignof(std::max_align_t)) == a);
+
+  auto* b = arena.allocate(16);
+  auto* moved = static_cast<U8*>(arena.reallocate(a, 64, 128, alignof(std::max_align_t)));
+  CHECK(moved != a);
+  CHECK(moved[0] == 42);
+
+  // Only the last allocation is given back.
+  auto used = arena.bytes_used();
+  arena.deallocate(b, 16);
+  CHECK(arena.bytes_used() == used);
+  arena.deallocate(moved, 128);
+  CHECK(arena.bytes_used() < used);
+}
+
+TEST_CASE("Containers in an arena") {
+  Arena arena;
+
+  auto numbers = make_arena_array<I32>(&arena);
+  for (I32 i = 0; i < 1000; ++i) {
+    numbers.pushBack(i);
+  }
+  CHECK(numbers[999] == 999);
+  CHECK(numbers.allocator().arena() == &arena);
+
+  auto str = make_arena_string(&arena, "hello");
+  str.append(", world");
+  CHECK(str == StringView{"hello, world"});
+
+  auto reserved = arena.bytes_reserved();
+  {
+    Arena::Scope scope{&arena};
+    auto temp = make_arena_array<U64>(&arena, 16);
+    temp.pushBack(1);
+  }
+  CHECK(arena.bytes_reserved() == reserved);
+}
+
+}  // namespace nu
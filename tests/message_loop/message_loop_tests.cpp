@@ -40,6 +40,16 @@ TEST_CASE("MessageLoop") {
     ml.run();
     REQUIRE(value == 2);
   }
+
+  SECTION("calls idle callback when the queue is empty") {
+    U32 idle_calls = 0;
+    ml.set_idle_callback([&idle_calls]() {
+      ++idle_calls;
+    });
+    ml.post_task([]() {});
+    ml.run_until_idle();
+    REQUIRE(idle_calls == 1);
+  }
 }
 
 }  // namespace nu
@@ -0,0 +1,62 @@
+#include <catch2/catch.hpp>
+
+#include "nucleus/streams/array_input_stream.h"
+#include "nucleus/streams/checksum_input_stream.h"
+#include "nucleus/streams/checksum_output_stream.h"
+#include "nucleus/streams/dynamic_buffer_output_stream.h"
+#include "nucleus/streams/utils.h"
+
+namespace nu {
+
+namespace {
+
+U64 hash_of(ArrayView<U8> data) {
+  Hasher hasher{Hasher::Algorithm::XXH64};
+  hasher.update(data);
+  return hasher.finish();
+}
+
+}  // namespace
+
+TEST_CASE("ChecksumInputStream") {
+  U8 data[1000];
+  for (MemSize i = 0; i < sizeof(data); ++i) {
+    data[i] = static_cast<U8>(i * 13);
+  }
+  ArrayView<U8> view{data, sizeof(data)};
+
+  ArrayInputStream source{view};
+  Hasher hasher{Hasher::Algorithm::XXH64};
+  ChecksumInputStream stream{&source, &hasher};
+
+  SECTION("hashes everything that is read") {
+    auto result = readEntireStream(&stream);
+    CHECK(result.size() == sizeof(data));
+    CHECK(hasher.finish() == hash_of(view));
+  }
+
+  SECTION("hashes skipped bytes") {
+    CHECK(stream.readU32() == 0x271A0D00);
+    CHECK(stream.setPosition(100));
+    CHECK(!stream.setPosition(50));
+    stream.skip(400);
+    CHECK(stream.getPosition() == 500);
+
+    readEntireStream(&stream);
+    CHECK(hasher.finish() == hash_of(view));
+  }
+}
+
+TEST_CASE("ChecksumOutputStream") {
+  DynamicBufferOutputStream destination;
+  Hasher hasher{Hasher::Algorithm::CRC32C};
+  ChecksumOutputStream stream{&destination, &hasher};
+
+  stream << "123";
+  stream << "456789";
+
+  CHECK(destination.buffer().size() == 9);
+  CHECK(hasher.finish() == 0xE3069283);
+}
+
+}  // namespace nu
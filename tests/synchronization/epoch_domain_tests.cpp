@@ -0,0 +1,93 @@
+#include <catch2/catch.hpp>
+
+#include "nucleus/synchronization/epoch_domain.h"
+
+namespace nu {
+
+namespace {
+
+void count_deletes(void* object) {
+  ++*static_cast<I32*>(object);
+}
+
+struct Node {
+  EpochDomain* domain;
+  Node* child;
+  I32* deletes;
+};
+
+// Deleting a node retires its child, the way a container retires what an old node points to.
+void delete_node(void* object) {
+  auto* node = static_cast<Node*>(object);
+  ++*node->deletes;
+  if (node->child) {
+    node->domain->retire(node->child, &delete_node);
+  }
+}
+
+}  // namespace
+
+TEST_CASE("EpochDomain") {
+  I32 deletes = 0;
+
+  SECTION("deletes right away without participants") {
+    EpochDomain domain;
+    domain.retire(&deletes, &count_deletes);
+    CHECK(deletes == 1);
+    CHECK(domain.pending() == 0);
+  }
+
+  SECTION("waits for all participants") {
+    EpochDomain domain;
+    EpochDomain::Participant first{&domain};
+    EpochDomain::Participant second{&domain};
+
+    domain.retire(&deletes, &count_deletes);
+    CHECK(deletes == 0);
+    CHECK(domain.pending() == 1);
+
+    first.quiescent();
+    domain.collect();
+    CHECK(deletes == 0);
+
+    second.quiescent();
+    domain.collect();
+    CHECK(deletes == 1);
+    CHECK(domain.pending() == 0);
+  }
+
+  SECTION("quiescent points before retiring do not count") {
+    EpochDomain domain;
+    EpochDomain::Participant participant{&domain};
+
+    participant.quiescent();
+    domain.retire(&deletes, &count_deletes);
+    CHECK(deletes == 0);
+
+    participant.quiescent();
+    domain.collect();
+    CHECK(deletes == 1);
+  }
+
+  SECTION("destroying a participant releases what it held back") {
+    EpochDomain domain;
+    {
+      EpochDomain::Participant participant{&domain};
+      domain.retire(&deletes, &count_deletes);
+      CHECK(deletes == 0);
+    }
+    CHECK(deletes == 1);
+  }
+
+  SECTION("deleters can retire objects") {
+    EpochDomain domain;
+    Node child{&domain, nullptr, &deletes};
+    Node parent{&domain, &child, &deletes};
+
+    domain.retire(&parent, &delete_node);
+    CHECK(deletes == 2);
+    CHECK(domain.pending() == 0);
+  }
+}
+
+}  // namespace nu
@@ -1,6 +1,7 @@
 
 #include <catch2/catch.hpp>
 
+#include "nucleus/testing/counting_allocator.h"
 #include "nucleus/text/dynamic_string.h"
 
 namespace nu {
@@ -72,4 +73,33 @@ TEST_CASE("DynamicString can erase text") {
   }
 }
 
+TEST_CASE("DynamicString gets its memory from the allocator") {
+  using testing::AllocationCounts;
+  using testing::CountingAllocator;
+  using String = BasicDynamicString<CountingAllocator>;
+
+  AllocationCounts counts;
+
+  {
+    String str{"testing", CountingAllocator{&counts}};
+    CHECK(counts.allocations == 1);
+    CHECK(counts.bytesInUse == str.capacity());
+
+    str.append(" with a string that no longer fits");
+    CHECK(str.view().compare("testing with a string that no longer fits") == 0);
+    CHECK(counts.bytesInUse == str.capacity());
+
+    String copy{str};
+    CHECK(copy == str);
+    CHECK(copy.allocator().counts() == &counts);
+
+    String other{CountingAllocator{&counts}};
+    other = std::move(copy);
+    CHECK(other == str);
+  }
+
+  CHECK(counts.allocations == counts.deallocations);
+  CHECK(counts.bytesInUse == 0);
+}
+
 }  // namespace nu
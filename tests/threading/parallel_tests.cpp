@@ -0,0 +1,168 @@
+#include <catch2/catch.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <functional>
+
+#include "nucleus/threading/parallel.h"
+
+namespace nu {
+
+namespace {
+
+DynamicArray<U32> make_numbers(MemSize count) {
+  DynamicArray<U32> result;
+  result.resize(count);
+
+  // Scrambled, but the same every time.
+  U32 state = 12345;
+  for (auto& number : result) {
+    state = state * 1664525u + 1013904223u;
+    number = state >> 8;
+  }
+
+  return result;
+}
+
+}  // namespace
+
+TEST_CASE("parallel_for") {
+  SECTION("over indices") {
+    // Every index is only visited by one thread.
+    DynamicArray<U32> visits;
+    visits.resize(50000, 0);
+
+    parallel_for(visits.size(), [&visits](MemSize index) {
+      visits[index] += 1;
+    });
+
+    for (U32 visit : visits) {
+      REQUIRE(visit == 1);
+    }
+  }
+
+  SECTION("over items") {
+    auto numbers = make_numbers(50000);
+
+    std::atomic<U64> total{0};
+    parallel_for(numbers.view(), [&total](const U32& number) {
+      total.fetch_add(number, std::memory_order_relaxed);
+    });
+
+    U64 expected = 0;
+    for (U32 number : numbers) {
+      expected += number;
+    }
+    CHECK(total.load() == expected);
+  }
+
+  SECTION("changing items") {
+    auto numbers = make_numbers(50000);
+    auto original = numbers;
+
+    parallel_for(&numbers, [](U32& number) {
+      number /= 2;
+    });
+
+    for (MemSize i = 0; i < numbers.size(); ++i) {
+      REQUIRE(numbers[i] == original[i] / 2);
+    }
+  }
+
+  SECTION("nothing to do") {
+    DynamicArray<I32> empty;
+    parallel_for(&empty, [](I32&) {
+      FAIL("Called for an empty array.");
+    });
+  }
+}
+
+TEST_CASE("parallel_reduce") {
+  auto numbers = make_numbers(100000);
+
+  U64 expected = 0;
+  for (U32 number : numbers) {
+    expected += number;
+  }
+
+  DynamicArray<U64> wide;
+  for (U32 number : numbers) {
+    wide.pushBack(number);
+  }
+  CHECK(parallel_reduce(wide.view(), U64{0}, std::plus<U64>{}) == expected);
+
+  SECTION("in order") {
+    // Keeping the first of two numbers is associative, but not commutative.
+    DynamicArray<I32> indices;
+    for (I32 i = 0; i < 20000; ++i) {
+      indices.pushBack(i);
+    }
+    auto first = parallel_reduce(indices.view(), -1, [](I32 left, I32 right) {
+      return left == -1 ? right : left;
+    });
+    CHECK(first == 0);
+  }
+
+  SECTION("small") {
+    DynamicArray<I32> few;
+    few.pushBack(1);
+    few.pushBack(2);
+    few.pushBack(3);
+    CHECK(parallel_reduce(few.view(), 10, std::plus<I32>{}) == 16);
+    CHECK(parallel_reduce(ArrayView<I32>{}, 10, std::plus<I32>{}) == 10);
+  }
+}
+
+TEST_CASE("parallel_transform") {
+  auto numbers = make_numbers(100000);
+
+  DynamicArray<U64> doubled;
+  doubled.pushBack(99);
+  parallel_transform(numbers.view(), &doubled, [](U32 number) {
+    return U64{number} * 2;
+  });
+
+  REQUIRE(doubled.size() == numbers.size());
+  for (MemSize i = 0; i < numbers.size(); ++i) {
+    REQUIRE(doubled[i] == U64{numbers[i]} * 2);
+  }
+}
+
+TEST_CASE("parallel_sort") {
+  for (MemSize count : {MemSize{0}, MemSize{1}, MemSize{100}, MemSize{5000}, MemSize{123457}}) {
+    auto numbers = make_numbers(count);
+    auto expected = numbers;
+    std::sort(expected.begin(), expected.end());
+
+    parallel_sort(&numbers);
+
+    REQUIRE(numbers.size() == expected.size());
+    for (MemSize i = 0; i < numbers.size(); ++i) {
+      REQUIRE(numbers[i] == expected[i]);
+    }
+  }
+
+  SECTION("with a comparison") {
+    auto numbers = make_numbers(70000);
+    parallel_sort(&numbers, std::greater<U32>{});
+    CHECK(std::is_sorted(numbers.begin(), numbers.end(), std::greater<U32>{}));
+  }
+}
+
+TEST_CASE("parallel_scan") {
+  for (MemSize count : {MemSize{0}, MemSize{1}, MemSize{100}, MemSize{5000}, MemSize{123457}}) {
+    auto numbers = make_numbers(count);
+
+    DynamicArray<U32> sums;
+    parallel_scan(numbers.view(), &sums, std::plus<U32>{});
+
+    REQUIRE(sums.size() == numbers.size());
+    U32 expected = 0;
+    for (MemSize i = 0; i < numbers.size(); ++i) {
+      expected += numbers[i];
+      REQUIRE(sums[i] == expected);
+    }
+  }
+}
+
+}  // namespace nu
@@ -0,0 +1,108 @@
+#include <catch2/catch.hpp>
+
+#include <atomic>
+
+#include "nucleus/threading/worker_pool.h"
+
+namespace nu {
+
+TEST_CASE("WorkerPool covers the whole range once") {
+  WorkerPool pool{3};
+  CHECK(pool.worker_count() == 3);
+
+  constexpr MemSize COUNT = 100000;
+  // Every index is only visited by one thread.
+  DynamicArray<U32> visits;
+  visits.resize(COUNT, 0);
+
+  // Catch assertions can not be used on the workers.
+  std::atomic<MemSize> ranges{0};
+  std::atomic<MemSize> empty_ranges{0};
+  auto func = [&](MemSize begin, MemSize end) {
+    if (begin >= end) {
+      empty_ranges.fetch_add(1);
+    }
+    for (MemSize i = begin; i < end; ++i) {
+      visits[i] += 1;
+    }
+    ranges.fetch_add(1);
+  };
+  pool.run(COUNT, 100, func);
+
+  for (U32 visit : visits) {
+    REQUIRE(visit == 1);
+  }
+  CHECK(empty_ranges.load() == 0);
+
+  // Ranges get smaller towards the end, so there are more of them than threads.
+  CHECK(ranges.load() > 4);
+}
+
+TEST_CASE("WorkerPool runs small ranges on the calling thread") {
+  WorkerPool pool{2};
+
+  bool on_worker = true;
+  MemSize calls = 0;
+  auto func = [&](MemSize begin, MemSize end) {
+    on_worker = WorkerPool::is_worker_thread();
+    CHECK(begin == 0);
+    CHECK(end == 10);
+    ++calls;
+  };
+  pool.run(10, 100, func);
+
+  CHECK(calls == 1);
+  CHECK_FALSE(on_worker);
+}
+
+TEST_CASE("WorkerPool without workers") {
+  WorkerPool pool{0};
+
+  MemSize total = 0;
+  auto func = [&](MemSize begin, MemSize end) {
+    total += end - begin;
+  };
+  pool.run(1000, 1, func);
+
+  CHECK(total == 1000);
+}
+
+TEST_CASE("WorkerPool runs nested work on the worker") {
+  WorkerPool pool{2};
+
+  std::atomic<MemSize> total{0};
+  auto outer = [&](MemSize begin, MemSize end) {
+    for (MemSize i = begin; i < end; ++i) {
+      auto inner = [&](MemSize inner_begin, MemSize inner_end) {
+        total.fetch_add(inner_end - inner_begin);
+      };
+      pool.run(100, 1, inner);
+    }
+  };
+  pool.run(64, 1, outer);
+
+  CHECK(total.load() == 6400);
+}
+
+TEST_CASE("WorkerPool with many callers") {
+  WorkerPool pool{2};
+
+  std::atomic<MemSize> total{0};
+  {
+    DynamicArray<JoinHandle> callers;
+    for (I32 i = 0; i < 4; ++i) {
+      callers.pushBack(spawn_thread([&]() {
+        for (I32 j = 0; j < 50; ++j) {
+          auto func = [&](MemSize begin, MemSize end) {
+            total.fetch_add(end - begin);
+          };
+          pool.run(1000, 10, func);
+        }
+      }));
+    }
+  }
+
+  CHECK(total.load() == 4 * 50 * 1000);
+}
+
+}  // namespace nu